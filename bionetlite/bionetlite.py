@@ -103,12 +103,6 @@ class NeuliteNetwork(DenseNetwork):
         self.convert_morphologies_flag = convert_morphologies
         self.convert_ion_channels_flag = convert_ion_channels
 
-        # Generate config.h if simulation_config is provided
-        if simulation_config is not None and generate_config_h:
-            if mpi_rank == 0:
-                logger.info("Generating config.h from simulation configuration")
-                self.generate_config_h(simulation_config)
-
         config_path = self._get_config_path()
 
         # Auto-copy BMTK example files if config.json does not exist and base_dir is detected.
@@ -152,6 +146,12 @@ class NeuliteNetwork(DenseNetwork):
             barrier()
         except Exception as e:
             logger.warning(f"Initialization warning: {e}")
+
+        # Generate config.h if simulation_config is provided; after the ion channels are converted, for CHANNEL_MASKS
+        if simulation_config is not None and generate_config_h:
+            if mpi_rank == 0:
+                logger.info("Generating config.h from simulation configuration")
+                self.generate_config_h(simulation_config)
     
     def add_nodes(self, N=1, **properties):
         """Add nodes to the network. Only biophysical nodes are supported."""
@@ -1345,6 +1345,26 @@ class NeuliteNetwork(DenseNetwork):
         
         logger.info(f"Ion channel conversion completed. Created {len(files)} CSV files in {actual_output_dir}")
 
+    def get_channel_masks(self, ion_dir=None):
+        """Channel masks of the converted ion channel CSV files, for CHANNEL_MASKS of config.h.
+
+        The kernel evaluates channel g of a population when the somatic gbar of g is not zero (CHANNEL_SPECIALIZE);
+        the gbar columns follow ion_gbar_t of kernel/ion.h (NaV .. Ca_LVA).
+
+        :param ion_dir: Directory of the CSV files. If None, uses ion_dir under neulite_dir
+        :return: sorted list of the distinct masks
+        """
+        if ion_dir is None:
+            ion_dir = os.path.join(self.neulite_dir, self.ion_dir)
+        masks = set()
+        for file in glob.glob(os.path.join(ion_dir, "*.csv")):
+            with open(file, 'r') as f:
+                for line in f:
+                    fields = line.split('#')[0].split(',')
+                    if len(fields) == 22 and fields[0].strip() == '1':  # 1 == SOMA
+                        masks.add(sum(1 << g for g, x in enumerate(fields[7:]) if float(x) != 0.0))
+        return sorted(masks)
+
     def get_simulation_params_from_config(self, config):
         """Extract simulation parameters from SonataConfig object
 
@@ -1399,6 +1419,7 @@ class NeuliteNetwork(DenseNetwork):
         # Extract parameters from SonataConfig
         params = self.get_simulation_params_from_config(config)
         logger.info("Loaded parameters from SonataConfig object")
+        channel_masks = ''.join(f"CHANNEL_VARIANT ( {m:#06x} ) " for m in self.get_channel_masks())
 
         lines = [
             "// Automatically generated by bionet_lite",
@@ -1416,6 +1437,34 @@ class NeuliteNetwork(DenseNetwork):
             f"#define SPIKE_THRESHOLD ( {params['spike_threshold']} )",
             "#define ALLACTIVE ( 0 ) // Set to 1 for allactive models",
             "",
+            "// Network parameters",
+            "#define REORDER ( 0 ) // Set to 1 to renumber neurons within each population by connectivity (reverse Cuthill-McKee)",
+            "",
+            "// Solver parameters",
+            "#define MULTISPLIT ( 0 ) // Set to N > 1 to solve the matrix of each large neuron as N parts in parallel (OpenMP)",
+            "#define MULTISPLIT_MIN_COMP ( 1000 ) // Neurons with fewer compartments are not split",
+            "#define RENUMBER ( 1 ) // Renumber the compartments of each morphology into long unbranched runs for the Hines solver",
+            "#define DLAMBDA ( 0.0 ) // Set to d > 0 to re-discretize each morphology at load time so that a compartment is at most d of the AC length constant (d_lambda rule; 0.1 is too coarse for the spike timing, see test/equivalence)",
+            "#define DLAMBDA_FREQ ( 100.0 ) // [Hz] frequency of the AC length constant of DLAMBDA",
+            "#define HINES_GEN ( 1 ) // Solve the morphologies covered by hines_gen.h (make hines) with their straight-line solvers",
+            "#define MIXED_PRECISION ( 0 ) // Set to 1 to store gates and synapses in float, 2 to solve the matrix in float as well (see precision.h)",
+            "#define QUIESCENT ( 0 ) // Set to 1 to skip neurons at rest until a synaptic input arrives or their current changes",
+            "#define QUIESCENT_DV ( 1e-6 ) // [mV] largest change of v over 1 ms of a neuron at rest",
+            "#define QUIESCENT_DCA ( 1e-9 ) // [mM] largest change of ca over 1 ms of a neuron at rest",
+            "#define QUIESCENT_DGATE ( 1e-6 ) // largest change of a gate over 1 ms of a neuron at rest",
+            "#define QUIESCENT_SUM0 ( 1e-6 ) // largest synaptic trace (sum0) of a neuron at rest",
+            "#define ADAPTIVE ( 0 ) // Set to 1 to choose the # of substeps of each neuron for each ms by error control (the population CSV is ignored)",
+            "#define ADAPTIVE_TOL ( 0.001 ) // [mV] largest local error of the somatic v per substep",
+            "#define ADAPTIVE_MAX_LEVEL ( 5 ) // the finest level uses DT, and each level below halves the # of substeps",
+            "#define CHANNEL_SPECIALIZE ( 1 ) // Set to 0 to evaluate all channels, also those with zero conductance",
+            f"#define CHANNEL_MASKS {channel_masks}// list of CHANNEL_VARIANT ( mask ) compiled with a constant channel mask; nl_bench prints the mask of each population",
+            "#define ION_LUT ( 0 ) // Set to 1 to interpolate the gate kinetics from tables instead of computing them (ion_gen.h)",
+            "#define ION_LUT_N ( 5001 ) // # rows of the tables, evenly spaced over the range of channels.json",
+            "",
+            "// Diagnostics",
+            "#define PROFILE ( 0 ) // Set to 1 to time each phase per population; the report goes to stderr and profile.json",
+            "#define PROGRESS_INTERVAL ( 1.0 ) // [s] wall-clock time between progress lines",
+            "",
             "// Current injection parameters",
             f"#define I_AMP ( {params['current_injection']['amp']} )",
             f"#define I_DELAY ( {params['current_injection']['delay']} )",
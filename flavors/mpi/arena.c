@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+arena_t *initialize_arena ( const size_t size )
+{
+  arena_t *a = calloc ( 1, sizeof ( arena_t ) );
+  a -> size = ( size + ARENA_HUGE_PAGE - 1 ) / ARENA_HUGE_PAGE * ARENA_HUGE_PAGE;
+  a -> used = 0;
+  if ( a -> size == 0 ) { return a; }
+
+  // Map one huge page more, so that the base can be aligned to a huge page
+  a -> map_size = a -> size + ARENA_HUGE_PAGE;
+  a -> map = mmap ( NULL, a -> map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+  if ( a -> map == MAP_FAILED ) { fprintf ( stderr, "Error: cannot map an arena of %zu bytes\n", a -> map_size ); exit ( 1 ); }
+  a -> base = ( char * ) ( ( ( uintptr_t ) a -> map + ARENA_HUGE_PAGE - 1 ) / ARENA_HUGE_PAGE * ARENA_HUGE_PAGE );
+#ifdef MADV_HUGEPAGE
+  madvise ( a -> base, a -> size, MADV_HUGEPAGE ); // a hint; the arena works on small pages as well
+#endif
+  return a;
+}
+
+void *arena_alloc ( arena_t *a, const size_t n, const size_t size )
+{
+  const size_t bytes = ARENA_SIZE ( n, size );
+  if ( a -> used + bytes > a -> size ) { fprintf ( stderr, "Error: arena overflow (%zu + %zu > %zu bytes)\n", a -> used, bytes, a -> size ); exit ( 1 ); }
+  void *p = a -> base + a -> used;
+  a -> used += bytes;
+  return p;
+}
+
+void finalize_arena ( arena_t *a )
+{
+  if ( a -> map_size > 0 ) { munmap ( a -> map, a -> map_size ); }
+  free ( a );
+}
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#pragma once
+
+#include <stddef.h>
+
+#define ARENA_CACHE_LINE ( 64 )
+#define ARENA_HUGE_PAGE  ( 2 * 1024 * 1024 )
+
+//
+// Arena: one huge-page aligned mapping, carved into cache-line aligned blocks in the order of arena_alloc.
+// The pages are zero and untouched until their first write, so they are placed on the NUMA node of the thread
+// that first writes them; fill the blocks of a neuron in the thread (and the order) that will compute it.
+// Blocks are not freed one by one; finalize_arena releases them all.
+//
+typedef struct {
+  char *base;       // huge-page aligned
+  size_t size, used;
+  void *map;        // the mapping, for munmap
+  size_t map_size;
+} arena_t;
+
+#define ARENA_SIZE(n,size) ( ( ( size_t ) ( n ) * ( size ) + ARENA_CACHE_LINE - 1 ) / ARENA_CACHE_LINE * ARENA_CACHE_LINE ) // bytes taken by arena_alloc
+
+extern arena_t *initialize_arena ( const size_t ); // the sum of ARENA_SIZE of the blocks
+extern void *arena_alloc ( arena_t *, const size_t, const size_t ); // zero-filled; n, size as calloc
+extern void finalize_arena ( arena_t * );
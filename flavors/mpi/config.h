@@ -13,7 +13,19 @@
 #define SPIKE_THRESHOLD ( -15.0 )
 #define ALLACTIVE ( 0 ) // Set to 1 for allactive models
 
+// Network parameters
+#define REORDER ( 0 ) // Set to 1 to renumber neurons within each population by connectivity (reverse Cuthill-McKee); requires MERGED_OUTPUT
+
 // Current injection parameters
 #define I_AMP ( 0.12 )
 #define I_DELAY ( 500.0 )
 #define I_DURATION ( 1000.0 )
+
+// Diagnostics
+#define PROFILE ( 0 ) // Set to 1 to time each phase per population; the report goes to stderr and profile.json (rank 0)
+#define PROGRESS_INTERVAL ( 1.0 ) // [s] wall-clock time between progress lines
+
+// Output parameters
+#define MERGED_OUTPUT ( 0 ) // Set to 1 to write single v.bin and s.bin with MPI-IO instead of v%d.dat and s%d.dat
+#define OUTPUT_BATCH_MS ( 100 ) // [ms] buffered between collective writes
+#define OUTPUT_AGGREGATORS ( 0 ) // # of MPI-IO aggregators, 0 == MPI default
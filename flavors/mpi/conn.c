@@ -6,53 +6,206 @@
 #include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <mpi.h>
 #include "conn.h"
 #include "neuron.h"
+#include "pario.h"
 #include "config.h"
 
+#define SHARD_MAGIC "NLCONN01"
+
 extern int strip_comment_destructive ( char * );
 extern int remove_blank_destructive_for_csv ( char * );
-extern int get_lines ( const char * );
 
-conn_t *initialize_connection ( const int n_each, const int n_offset, const population_t *u, const neuron_t *n, const char *filename )
+typedef struct {
+  char magic [ 8 ];
+  int mpi_size, mpi_rank;
+  long long n_records;
+} shard_header_t; // header of a pre-sharded binary connection file
+
+_Static_assert ( sizeof ( conn_record_t ) == 48 && sizeof ( shard_header_t ) == 24, "binary layout must match helper/shard_connection.py" );
+
+//
+// CSV: every rank reads only its byte range of the file and parses it.
+//
+static conn_record_t *read_csv ( const char *filename, long *n_records )
 {
+  size_t size;
+  char *text = pario_read_lines ( filename, &size );
+
+  long n_parsed = 0, capacity = 1024;
+  conn_record_t *parsed = malloc ( capacity * sizeof ( conn_record_t ) );
+  if ( size > 0 ) {
+    FILE *file = fmemopen ( text, size, "r" );
+    char buf [ PARIO_MAX_LINE ];
+    while ( fgets ( buf, PARIO_MAX_LINE, file ) ) {
+      if ( strip_comment_destructive ( buf ) == 0 ) { continue; }
+      if ( remove_blank_destructive_for_csv ( buf ) == 0 ) { continue; }
+      conn_record_t r;
+      char c_type;
+      const int nf = sscanf ( buf, "%d,%d,%d,%lf,%lf,%lf,%lf,%d,%c", &r.pre, &r.post_i, &r.post_c, &r.weight, &r.decay, &r.rise, &r.erev, &r.delay, &c_type );
+      assert ( nf == 9 );
+      if ( n_parsed == capacity ) { capacity *= 2; parsed = realloc ( parsed, capacity * sizeof ( conn_record_t ) ); }
+      parsed [ n_parsed++ ] = r;
+    }
+    fclose ( file );
+  }
+  free ( text );
+
+  *n_records = n_parsed;
+  return parsed;
+}
+
+//
+// Send each record to the rank that owns its postsynaptic neuron.
+// Records from lower ranks come first, so the received records keep the order in the file.
+//
+static conn_record_t *distribute ( const int n_each, conn_record_t *parsed, long *n_records )
+{
+  int mpi_size; MPI_Comm_size ( MPI_COMM_WORLD, &mpi_size );
+  const long n_parsed = *n_records;
+
+  int *send_counts = calloc ( mpi_size, sizeof ( int ) );
+  for ( long i = 0; i < n_parsed; i++ ) {
+    assert ( 0 <= parsed [ i ].post_i && parsed [ i ].post_i / n_each < mpi_size );
+    send_counts [ parsed [ i ].post_i / n_each ]++;
+  }
+
+  // Bucket records by destination rank (stable)
+  int *send_displs = calloc ( mpi_size, sizeof ( int ) );
+  for ( int i = 1; i < mpi_size; i++ ) { send_displs [ i ] = send_displs [ i - 1 ] + send_counts [ i - 1 ]; }
+  conn_record_t *send_buf = malloc ( ( n_parsed ? n_parsed : 1 ) * sizeof ( conn_record_t ) );
+  {
+    int *pos = calloc ( mpi_size, sizeof ( int ) );
+    for ( long i = 0; i < n_parsed; i++ ) {
+      const int dst = parsed [ i ].post_i / n_each;
+      send_buf [ send_displs [ dst ] + pos [ dst ]++ ] = parsed [ i ];
+    }
+    free ( pos );
+  }
+  free ( parsed );
+
+  int *recv_counts = calloc ( mpi_size, sizeof ( int ) );
+  MPI_Alltoall ( send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, MPI_COMM_WORLD );
+  int *recv_displs = calloc ( mpi_size, sizeof ( int ) );
+  for ( int i = 1; i < mpi_size; i++ ) { recv_displs [ i ] = recv_displs [ i - 1 ] + recv_counts [ i - 1 ]; }
+  const long n_recv = recv_displs [ mpi_size - 1 ] + recv_counts [ mpi_size - 1 ];
+  conn_record_t *records = malloc ( ( n_recv ? n_recv : 1 ) * sizeof ( conn_record_t ) );
+
+  MPI_Datatype record_type;
+  MPI_Type_contiguous ( sizeof ( conn_record_t ), MPI_BYTE, &record_type );
+  MPI_Type_commit ( &record_type );
+  MPI_Alltoallv ( send_buf, send_counts, send_displs, record_type, records, recv_counts, recv_displs, record_type, MPI_COMM_WORLD );
+  MPI_Type_free ( &record_type );
+
+  free ( send_buf );
+  free ( send_counts );
+  free ( send_displs );
+  free ( recv_counts );
+  free ( recv_displs );
+
+  *n_records = n_recv;
+  return records;
+}
+
+//
+// Pre-sharded binary: the file name contains "%d", which is replaced by the rank.
+// Each file holds only the records whose postsynaptic neurons are owned by that rank.
+//
+static conn_record_t *read_shard ( const char *pattern, long *n_records )
+{
+  int mpi_size; MPI_Comm_size ( MPI_COMM_WORLD, &mpi_size );
+  int mpi_rank; MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
+
+  char filename [ 1024 ];
+  snprintf ( filename, sizeof ( filename ), pattern, mpi_rank );
+  FILE *file = fopen ( filename, "rb" );
+  if ( ! file ) { fprintf ( stderr, "Error: no such file %s\n", filename ); MPI_Abort ( MPI_COMM_WORLD, 1 ); }
+
+  shard_header_t h;
+  if ( fread ( &h, sizeof ( h ), 1, file ) != 1 || memcmp ( h.magic, SHARD_MAGIC, 8 ) != 0 ) {
+    fprintf ( stderr, "Error: %s is not a connection shard\n", filename ); MPI_Abort ( MPI_COMM_WORLD, 1 );
+  }
+  if ( h.mpi_size != mpi_size || h.mpi_rank != mpi_rank ) {
+    fprintf ( stderr, "Error: %s was made for rank %d of %d, but this is rank %d of %d\n", filename, h.mpi_rank, h.mpi_size, mpi_rank, mpi_size );
+    MPI_Abort ( MPI_COMM_WORLD, 1 );
+  }
+  conn_record_t *records = malloc ( ( h.n_records ? h.n_records : 1 ) * sizeof ( conn_record_t ) );
+  if ( fread ( records, sizeof ( conn_record_t ), h.n_records, file ) != ( size_t ) h.n_records ) {
+    fprintf ( stderr, "Error: %s is truncated\n", filename ); MPI_Abort ( MPI_COMM_WORLD, 1 );
+  }
+  fclose ( file );
+
+  *n_records = h.n_records;
+  return records;
+}
+
+static const conn_record_t *sort_records;
+static int compare_pre ( const void *a, const void *b )
+{
+  const long i = *( const long * ) a, j = *( const long * ) b;
+  const int pi = sort_records [ i ].pre, pj = sort_records [ j ].pre;
+  return ( pi != pj ) ? ( pi > pj ) - ( pi < pj ) : ( i > j ) - ( i < j );
+}
+
+// Records must be grouped by presynaptic neuron in ascending order; keep the original order within a group
+static void sort_by_pre ( conn_record_t *records, const long n_records )
+{
+  int sorted = 1;
+  for ( long i = 1; i < n_records; i++ ) { if ( records [ i - 1 ].pre > records [ i ].pre ) { sorted = 0; break; } }
+  if ( sorted ) { return; }
+
+  long *order = malloc ( n_records * sizeof ( long ) );
+  for ( long i = 0; i < n_records; i++ ) { order [ i ] = i; }
+  sort_records = records;
+  qsort ( order, n_records, sizeof ( long ), compare_pre );
+  conn_record_t *tmp = malloc ( n_records * sizeof ( conn_record_t ) );
+  for ( long i = 0; i < n_records; i++ ) { tmp [ i ] = records [ order [ i ] ]; }
+  memcpy ( records, tmp, n_records * sizeof ( conn_record_t ) );
+  free ( tmp );
+  free ( order );
+}
+
+conn_record_t *read_connection ( const char *filename, long *n_records )
+{
+  return ( strstr ( filename, "%d" ) ) ? read_shard ( filename, n_records ) : read_csv ( filename, n_records );
+}
+
+conn_t *initialize_connection ( const int n_each, const int n_offset, const population_t *u, const neuron_t *n, const char *filename, conn_record_t *records, long n_records, const int *new_id )
+{
+  if ( new_id != NULL ) {
+    for ( long r = 0; r < n_records; r++ ) { records [ r ].pre = new_id [ records [ r ].pre ]; records [ r ].post_i = new_id [ records [ r ].post_i ]; }
+  }
+  if ( new_id != NULL || ! strstr ( filename, "%d" ) ) { records = distribute ( n_each, records, &n_records ); } // shards are already distributed unless renumbered
+  sort_by_pre ( records, n_records );
+
   conn_t *c = calloc (1, sizeof ( conn_t ) );
 
-  if ( n -> n_neuron == 0 ) { c -> n_conn = 0; return c; }
-  
+  if ( n -> n_neuron == 0 ) { c -> n_conn = 0; free ( records ); return c; }
+
   int *pre_table = calloc ( 0, sizeof ( int ) ); // allocate dynamically
   int *pre_ary   = calloc ( 0, sizeof ( int ) ); // allocate dynamically
   int *post_ary  = calloc ( n -> n_neuron, sizeof ( int ) );
   int n_conn = 0, n_pre = 0;
   {
-    char buf [ 1024 ] ;
-    FILE *file = fopen ( filename, "r" );
-    if ( ! file ) { fprintf ( stderr, "Error: no such file %s\n", filename ); exit ( 1 ); }
-
     int pre = -1, pre_ary_size = 0, pre_table_size = 0;
-    while ( fgets ( buf, 1024, file ) ) {
-      if ( strip_comment_destructive ( buf ) == 0 ) { continue; }
-      if ( remove_blank_destructive_for_csv ( buf ) == 0 ) { continue; }
-      int d_pre, d_post_i;
-      const int nf = sscanf ( buf, "%d,%d", &d_pre, &d_post_i );
-      assert ( nf == 2 );
-      if ( n_offset <= d_post_i && d_post_i < n_offset + n_each ) {
-	n_conn += 2;
-        if ( pre < d_pre ) {
-	  pre_table_size++;
-	  pre_table = realloc ( pre_table, pre_table_size * sizeof ( int ) );
-	  pre_table [ pre_table_size - 1 ] = d_pre;
-	  pre = d_pre;
-	  pre_ary_size++;
-	  pre_ary = realloc ( pre_ary, pre_ary_size * sizeof ( int ) );
-	  pre_ary [ pre_ary_size - 1 ] = 2;
-	} else {
-	  pre_ary [ pre_ary_size - 1 ] += 2;
-	}
-	post_ary [ d_post_i - n_offset ] += 2;
+    for ( long r = 0; r < n_records; r++ ) {
+      const int d_pre = records [ r ].pre, d_post_i = records [ r ].post_i;
+      assert ( n_offset <= d_post_i && d_post_i < n_offset + n_each );
+      n_conn += 2;
+      if ( pre < d_pre ) {
+	pre_table_size++;
+	pre_table = realloc ( pre_table, pre_table_size * sizeof ( int ) );
+	pre_table [ pre_table_size - 1 ] = d_pre;
+	pre = d_pre;
+	pre_ary_size++;
+	pre_ary = realloc ( pre_ary, pre_ary_size * sizeof ( int ) );
+	pre_ary [ pre_ary_size - 1 ] = 2;
+      } else {
+	pre_ary [ pre_ary_size - 1 ] += 2;
       }
+      post_ary [ d_post_i - n_offset ] += 2;
     }
-    fclose ( file );
     assert ( pre_table_size == pre_ary_size );
     n_pre = pre_table_size;
   }
@@ -71,7 +224,7 @@ conn_t *initialize_connection ( const int n_each, const int n_offset, const popu
   free ( pre_table );
   free ( pre_ary );
   free ( post_ary );
-  
+
   c -> post_c = calloc ( c -> n_conn, sizeof ( int ) );
   c -> weight = calloc ( c -> n_conn, sizeof ( double ) );
   c -> erev   = calloc ( c -> n_conn, sizeof ( double ) );
@@ -79,53 +232,42 @@ conn_t *initialize_connection ( const int n_each, const int n_offset, const popu
   c -> delay = calloc ( c -> n_conn, sizeof ( int ) );
   c -> id    = calloc ( c -> n_conn, sizeof ( int ) );
 
-  { 
+  {
     int *local_idx = calloc ( c -> n_post, sizeof ( int ) );
-    FILE *file = fopen ( filename, "r" );
-    char buf [ 1024 ];
     int idx = 0;
-    while ( fgets ( buf, 1024, file ) ) {
-      if ( strip_comment_destructive ( buf ) == 0 ) { continue; }
-      if ( remove_blank_destructive_for_csv ( buf ) == 0 ) { continue; }
-      int d_pre, d_post_i, d_post_c, d_delay;
-      double f_weight, f_decay, f_rise, f_erev;
-      char c_type;
-      const int nf = sscanf ( buf, "%d,%d,%d,%lf,%lf,%lf,%lf,%d,%c", &d_pre, &d_post_i, &d_post_c, &f_weight, &f_decay, &f_rise, &f_erev, &d_delay, &c_type );
-      assert ( nf == 9 );
+    for ( long r = 0; r < n_records; r++ ) {
+      const int d_post_i = records [ r ].post_i, d_post_c = records [ r ].post_c, d_delay = records [ r ].delay;
+      const double f_weight = records [ r ].weight, f_decay = records [ r ].decay, f_rise = records [ r ].rise, f_erev = records [ r ].erev;
 
-      if ( n_offset <= d_post_i && d_post_i < n_offset + n_each ) {
-	assert ( d_post_c < u -> n_comp [ n -> pid [ d_post_i - n_offset ] ] );
-      }
+      assert ( d_post_c < u -> n_comp [ n -> pid [ d_post_i - n_offset ] ] );
       assert ( d_delay > 0 );
-      
-      if ( n_offset <= d_post_i && d_post_i < n_offset + n_each ) {
-	const double tau_prime = f_decay * f_rise / ( f_decay - f_rise );
-	const double tau_diff  = f_rise / f_decay;
-	const double norm_coef = 1.0 / ( pow ( tau_diff, ( tau_prime / f_decay ) ) - pow ( tau_diff, ( tau_prime / f_rise ) ) );
-	const int solver_id1 = c -> ptr_post [ d_post_i - n_offset ] + local_idx [ d_post_i - n_offset ];
-	c -> post_c [ solver_id1 ] = d_post_c;
-	c -> weight [ solver_id1 ] = norm_coef * f_weight;
-	c -> erev   [ solver_id1 ] = f_erev;
-	c -> decay  [ solver_id1 ] = exp ( - DT / f_decay );
-	local_idx [ d_post_i - n_offset ]++;
-	c -> delay [ idx ] = d_delay;
-	c -> id    [ idx ] = solver_id1;
-	idx++;
-	const int solver_id2 = c -> ptr_post [ d_post_i - n_offset ] + local_idx [ d_post_i - n_offset ];
-	c -> post_c [ solver_id2 ] = d_post_c;
-	c -> weight [ solver_id2 ] = - norm_coef * f_weight;
-	c -> erev   [ solver_id2 ] = f_erev;
-	c -> decay  [ solver_id2 ] = exp ( - DT / f_rise );
-	local_idx [ d_post_i - n_offset ]++;
-	c -> delay [ idx ] = d_delay;
-	c -> id    [ idx ] = solver_id2;
-	idx++;
-      }
+
+      const double tau_prime = f_decay * f_rise / ( f_decay - f_rise );
+      const double tau_diff  = f_rise / f_decay;
+      const double norm_coef = 1.0 / ( pow ( tau_diff, ( tau_prime / f_decay ) ) - pow ( tau_diff, ( tau_prime / f_rise ) ) );
+      const int solver_id1 = c -> ptr_post [ d_post_i - n_offset ] + local_idx [ d_post_i - n_offset ];
+      c -> post_c [ solver_id1 ] = d_post_c;
+      c -> weight [ solver_id1 ] = norm_coef * f_weight;
+      c -> erev   [ solver_id1 ] = f_erev;
+      c -> decay  [ solver_id1 ] = exp ( - DT / f_decay );
+      local_idx [ d_post_i - n_offset ]++;
+      c -> delay [ idx ] = d_delay;
+      c -> id    [ idx ] = solver_id1;
+      idx++;
+      const int solver_id2 = c -> ptr_post [ d_post_i - n_offset ] + local_idx [ d_post_i - n_offset ];
+      c -> post_c [ solver_id2 ] = d_post_c;
+      c -> weight [ solver_id2 ] = - norm_coef * f_weight;
+      c -> erev   [ solver_id2 ] = f_erev;
+      c -> decay  [ solver_id2 ] = exp ( - DT / f_rise );
+      local_idx [ d_post_i - n_offset ]++;
+      c -> delay [ idx ] = d_delay;
+      c -> id    [ idx ] = solver_id2;
+      idx++;
     }
     free ( local_idx );
-    fclose ( file );
   }
-  
+  free ( records );
+
   return c;
 }
 
@@ -1,4 +1,3 @@
-
 // SPDX-License-Identifier: GPL-2.0-only
 // Copyright (C) 2024,2025,2026 Neulite Core Team <neulite-core@numericalbrain.org>
 
@@ -7,6 +6,12 @@
 #include "popl.h"
 #include "neuron.h"
 
+// One line of the connection file. This is also the record layout of pre-sharded binary connection files (see helper/shard_connection.py).
+typedef struct {
+  int pre, post_i, post_c, delay;
+  double weight, decay, rise, erev;
+} conn_record_t;
+
 typedef struct {
   int *post_c; // for solver
   double *weight, *erev, *decay; // for solver
@@ -16,5 +21,6 @@ typedef struct {
   int *ptr_pre, *ptr_post; // cumulative connection id
 } conn_t;
 
-extern conn_t *initialize_connection ( const int, const int, const population_t *, const neuron_t *, const char * );
+extern conn_record_t *read_connection ( const char *, long * ); // collective; this rank's share of the file, not yet distributed to the owners
+extern conn_t *initialize_connection ( const int, const int, const population_t *, const neuron_t *, const char *, conn_record_t *, long, const int * ); // the records of read_connection from the file, which are freed; the last argument maps ids in the file to neuron ids ( NULL == identity )
 extern void finalize_connection ( conn_t * );
@@ -4,8 +4,12 @@
 #include <stdio.h>
 #include <stdlib.h> // for exit
 #include <mpi.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "network.h"
 #include "solver.h"
+#include "timer.h"
 #include "config.h"
 
 extern int get_global_n_neurons ( const char * );
@@ -17,11 +21,22 @@ int main ( int argc, char *argv [ ] )
 {
   if ( argc < 3 ) { fprintf ( stderr, "usage: %s <population_csv> <connection_csv>\n", argv [ 0 ] ); exit ( 1 ); }
   
-  MPI_Init ( &argc, &argv );
+  // Hybrid MPI + OpenMP: threads share the neurons of a rank, and only the master thread calls MPI
+  int mpi_thread; MPI_Init_thread ( &argc, &argv, MPI_THREAD_FUNNELED, &mpi_thread );
   int mpi_size; MPI_Comm_size ( MPI_COMM_WORLD, &mpi_size );
   int mpi_rank; MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
   char mpi_host [ 1024 ]; { int len; MPI_Get_processor_name ( mpi_host, &len ); mpi_host [ len ] = '\0'; }
-  fprintf ( stderr, "Hello from %s: rank %d of %d\n", mpi_host, mpi_rank, mpi_size );
+#ifdef _OPENMP
+  const int n_threads = omp_get_max_threads ( );
+#else
+  const int n_threads = 1;
+#endif
+  fprintf ( stderr, "Hello from %s: rank %d of %d, %d thread(s)\n", mpi_host, mpi_rank, mpi_size, n_threads );
+  if ( n_threads > 1 && mpi_thread < MPI_THREAD_FUNNELED ) {
+    if ( mpi_rank == 0 ) { fprintf ( stderr, "Error: the MPI library does not support MPI_THREAD_FUNNELED\n" ); }
+    MPI_Finalize ( );
+    exit ( 1 );
+  }
   
   const int global_n_neurons = get_global_n_neurons ( argv [ 1 ] );
   if ( mpi_size > global_n_neurons ) {
@@ -33,9 +48,10 @@ int main ( int argc, char *argv [ ] )
   network_t *n = initialize_network ( mpi_size, mpi_rank, argv [ 1 ], argv [ 2 ] );
   solver_t *s  = initialize_solver  ( n -> u );
   
+  timer_initialize ( n -> u );
   const double timer_start = get_time ( );
   for ( int t_ms = 0; t_ms < TSTOP; t_ms++ ) {
-    if ( mpi_rank == 0 ) { fprintf ( stderr, "t = %d\n", t_ms ); };
+    timer_progress ( t_ms );
     
     set_current ( t_ms, n, constant_current );
     solve_network ( t_ms, n, s );
@@ -43,6 +59,7 @@ int main ( int argc, char *argv [ ] )
   }
   const double timer_stop = get_time ( );
   if ( mpi_rank == 0 ) { fprintf ( stderr, "Elapsed time = %f sec.\n", timer_stop - timer_start ); }
+  timer_finalize ( timer_stop - timer_start );
   
   finalize_solver  ( s );
   finalize_network ( n );
@@ -8,8 +8,13 @@
 #include <mpi.h>
 #include <assert.h>
 #include "network.h"
+#include "timer.h"
 #include "config.h"
 
+#if REORDER == 1 && MERGED_OUTPUT == 0
+#error "REORDER requires MERGED_OUTPUT, since renumbered ranks no longer own consecutive ids for v%d.dat"
+#endif
+
 extern int get_global_n_neurons ( const char * );
 
 network_t *initialize_network ( const int mpi_size, const int mpi_rank, const char *population_file, const char *connection_file )
@@ -23,10 +28,33 @@ network_t *initialize_network ( const int mpi_size, const int mpi_rank, const ch
   net -> u = initialize_population ( n_each, n_offset, population_file );
   net -> n = initialize_neuron     ( net -> u );
   net -> i = initialize_ion        ( net -> n );
-  net -> c = initialize_connection ( n_each, n_offset, net -> u, net -> n, connection_file );
+  long n_records;
+  conn_record_t *records = read_connection ( connection_file, &n_records ); // read once, for both the ordering and the connections
+  int *new_id = ( REORDER == 1 ) ? reorder_neurons ( net -> global_n_neurons, population_file, records, n_records ) : NULL;
+  net -> c = initialize_connection ( n_each, n_offset, net -> u, net -> n, connection_file, records, n_records, new_id );
   net -> s = initialize_synapse    ( net -> c );
+
+  // Ids in the outputs are those of the CSV files; out_order lists the local neurons in ascending output id
+  net -> gid       = calloc ( net -> n -> n_neuron, sizeof ( int ) );
+  net -> out_order = calloc ( net -> n -> n_neuron, sizeof ( int ) );
+  if ( new_id != NULL ) {
+    int k = 0;
+    for ( int g = 0; g < net -> global_n_neurons; g++ ) {
+      const int i = new_id [ g ] - n_offset;
+      if ( 0 <= i && i < net -> n -> n_neuron ) { net -> gid [ i ] = g; net -> out_order [ k++ ] = i; }
+    }
+    assert ( k == net -> n -> n_neuron );
+    free ( new_id );
+  } else {
+    for ( int i = 0; i < net -> n -> n_neuron; i++ ) { net -> gid [ i ] = n_offset + i; net -> out_order [ i ] = i; }
+  }
   
-  {
+  if ( MERGED_OUTPUT == 1 ) {
+    int column [ net -> n -> n_neuron + 1 ];
+    for ( int k = 0; k < net -> n -> n_neuron; k++ ) { column [ k ] = net -> gid [ net -> out_order [ k ] ]; }
+    net -> out = pario_open_output ( net -> global_n_neurons, net -> n -> n_neuron, column );
+    net -> v_row = calloc ( net -> n -> n_neuron + 1, sizeof ( double ) );
+  } else {
     char filename [ 1024 ];
     snprintf ( filename, sizeof ( filename ), "v%d.dat", mpi_rank );
     net -> v_dat = fopen ( filename, "w" );
@@ -45,8 +73,12 @@ network_t *initialize_network ( const int mpi_size, const int mpi_rank, const ch
 void finalize_network ( network_t *net )
 {
   free ( net -> spike  );
-  fclose ( net -> s_dat );
-  fclose ( net -> v_dat );
+  free ( net -> gid );
+  free ( net -> out_order );
+  free ( net -> v_row );
+  if ( net -> out   != NULL ) { pario_close_output ( net -> out ); }
+  if ( net -> s_dat != NULL ) { fclose ( net -> s_dat ); }
+  if ( net -> v_dat != NULL ) { fclose ( net -> v_dat ); }
   finalize_synapse    ( net -> s );
   finalize_connection ( net -> c );
   finalize_ion        ( net -> i );
@@ -57,14 +89,8 @@ void finalize_network ( network_t *net )
 
 void set_current ( const int t_ms, network_t *net, double ( *current ) ( const int, const int ) )
 {
-  // Detailed
-  //const int n_each   = ( net -> global_n_neurons + net -> mpi_size - 1 ) / net -> mpi_size;
-  //const int n_offset = n_each * net -> mpi_rank;
-  //for ( int i = n_offset; i < MIN(n_offset + n_each, net -> global_n_neurons); i++ ) {
-  //  net -> n -> i_ext [ net -> n -> sid [ i - n_offset ] ] = current ( t_ms, i );
-  //}
-  // Simple
-  for ( int i = 0; i < net -> n -> n_neuron; i++ ) { net -> n -> i_ext [ net -> n -> sid [ i ] ] = current ( t_ms, i ); }
+  // current ( ) is given the id in the CSV files, as in the outputs
+  for ( int i = 0; i < net -> n -> n_neuron; i++ ) { net -> n -> i_ext [ net -> n -> sid [ i ] ] = current ( t_ms, net -> gid [ i ] ); }
 }
 
 void solve_network ( const int t_ms, network_t *net, solver_t *solver )
@@ -73,7 +99,13 @@ void solve_network ( const int t_ms, network_t *net, solver_t *solver )
 
   double *v_hist = calloc ( n -> n_neuron * INV_DT, sizeof ( double ) );
   
+  // Neurons are independent within 1 ms. The schedule is static, as the first touch in initialize_solver,
+  // so that each thread solves the neurons whose solver blocks are on its NUMA node.
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( static )
+#endif
   for ( int i = 0; i < n -> n_neuron; i++ ) {
+    TIMER_BEGIN ( t0 );
     const int sid = n -> sid [ i ];
     double v_prev = n -> v [ sid ];
     int spike = 0;
@@ -84,28 +116,56 @@ void solve_network ( const int t_ms, network_t *net, solver_t *solver )
       v_prev = n -> v [ sid ];
     }
     net -> spike [ i ] = ( spike > 0 );
+    TIMER_END ( t0, T_SPIKE, n -> pid [ i ] ); // the phases inside solve are subtracted in the report
   }
   
+  TIMER_BEGIN ( t1 );
   for ( int iter = 0; iter < INV_DT; iter++ ) {
-    fprintf ( net -> v_dat, "%f ", t_ms + DT * iter );
     for ( int i = 0; i < n -> n_neuron; i++ ) {
       if ( isnan ( v_hist [ iter + INV_DT * i ] ) ) { fprintf ( stderr, "nan: %d\n", i ); exit ( 1 ); }
-      fprintf ( net -> v_dat, "%f%s", v_hist [ iter + INV_DT * i ], ( i == n -> n_neuron - 1 ) ? "\n" : " " );
+    }
+    if ( MERGED_OUTPUT == 1 ) {
+      for ( int k = 0; k < n -> n_neuron; k++ ) { net -> v_row [ k ] = v_hist [ iter + INV_DT * net -> out_order [ k ] ]; }
+      pario_append_v ( net -> out, net -> v_row );
+    } else {
+      fprintf ( net -> v_dat, "%f ", t_ms + DT * iter );
+      for ( int i = 0; i < n -> n_neuron; i++ ) {
+	fprintf ( net -> v_dat, "%f%s", v_hist [ iter + INV_DT * i ], ( i == n -> n_neuron - 1 ) ? "\n" : " " );
+      }
     }
   }
+  TIMER_END ( t1, T_OUTPUT, -1 );
   
   free ( v_hist );
 }
 
+static int find_pre ( const conn_t *c, const int pre ) // binary search in the sorted pre_table; -1 if not found
+{
+  int lo = 0, hi = c -> n_pre - 1;
+  while ( lo <= hi ) {
+    const int mid = lo + ( hi - lo ) / 2;
+    if      ( c -> pre_table [ mid ] < pre ) { lo = mid + 1; }
+    else if ( c -> pre_table [ mid ] > pre ) { hi = mid - 1; }
+    else { return mid; }
+  }
+  return -1;
+}
+
 void spike_propagation ( const int t_ms, network_t *net )
 {
   const int n_each   = ( net -> global_n_neurons + net -> mpi_size - 1 ) / net -> mpi_size;
   const int n_offset = n_each * net -> mpi_rank;
   const int mpi_size = net -> mpi_size;
   
+  TIMER_BEGIN ( t0 );
   for ( int i = 0; i < net -> n -> n_neuron; i++ ) {
-    if ( net -> spike [ i ] ) { fprintf ( net -> s_dat, "%d %d\n", t_ms, n_offset + i ); }
+    if ( net -> spike [ i ] ) {
+      if ( MERGED_OUTPUT == 1 ) { pario_append_spike ( net -> out, t_ms, net -> gid [ i ] ); }
+      else                      { fprintf ( net -> s_dat, "%d %d\n", t_ms, net -> gid [ i ] ); }
+    }
   }
+  TIMER_END ( t0, T_OUTPUT, -1 );
+  TIMER_BEGIN ( t1 );
 
   add_spike_to_synapse_per_ms ( net -> c, net -> s ); // Add spike after delayed period is over
 
@@ -121,7 +181,9 @@ void spike_propagation ( const int t_ms, network_t *net )
     
   // Gather # of neurons that emitted a spike on each process
   int *spike_counts = malloc ( mpi_size * sizeof ( int ) );
+  TIMER_BEGIN ( t2 );
   MPI_Allgather ( &local_count, 1, MPI_INT, spike_counts, 1, MPI_INT, MPI_COMM_WORLD );
+  TIMER_END ( t2, T_MPI_WAIT, -1 );
     
   // Calculate offsets
   int *displs = malloc ( mpi_size * sizeof ( int ) );
@@ -133,7 +195,9 @@ void spike_propagation ( const int t_ms, network_t *net )
   // Gather the neuron IDs
   int total_spikes = displs [ mpi_size - 1 ] + spike_counts [ mpi_size - 1 ];
   int *global_spiking_neurons = malloc ( total_spikes * sizeof ( int ) );
+  TIMER_BEGIN ( t3 );
   MPI_Allgatherv ( local_spiking_neurons, local_count, MPI_INT, global_spiking_neurons, spike_counts, displs, MPI_INT, MPI_COMM_WORLD );
+  TIMER_END ( t3, T_MPI_WAIT, -1 );
 
   // Copy to spiking_neurons for backward compatibility
   const int size_spiking_neurons = total_spikes;
@@ -151,21 +215,19 @@ void spike_propagation ( const int t_ms, network_t *net )
   //
   // Spike propagation
   //
+  // Each connection has exactly one presynaptic neuron, so spiking neurons can be delivered in parallel.
   const conn_t *c = net -> c;
   synapse_t *s = net -> s;
-  int neuron_idx = 0, table_idx = 0;
-  while ( neuron_idx < size_spiking_neurons && table_idx < c -> n_pre ) {
-    if        ( spiking_neurons [ neuron_idx ] < c -> pre_table [ table_idx ] ) {
-      neuron_idx++;
-    } else if ( spiking_neurons [ neuron_idx ] > c -> pre_table [ table_idx ] ) {
-      table_idx++;
-    } else {
-      for ( int j = c -> ptr_pre [ table_idx ]; j < c -> ptr_pre [ table_idx + 1 ]; j++ ) {
-	s -> delay [ c -> id [ j ] ] = ( 1 << c -> delay [ j ] );
-      }
-      table_idx++;
-      neuron_idx++;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic, 16 )
+#endif
+  for ( int neuron_idx = 0; neuron_idx < size_spiking_neurons; neuron_idx++ ) {
+    const int table_idx = find_pre ( c, spiking_neurons [ neuron_idx ] );
+    if ( table_idx < 0 ) { continue; }
+    for ( int j = c -> ptr_pre [ table_idx ]; j < c -> ptr_pre [ table_idx + 1 ]; j++ ) {
+      s -> delay [ c -> id [ j ] ] = ( 1 << c -> delay [ j ] );
     }
   }
   free ( spiking_neurons );
+  TIMER_END ( t1, T_PROPAGATION, -1 ); // mpi_wait is subtracted in the report
 }
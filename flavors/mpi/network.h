@@ -9,6 +9,8 @@
 #include "conn.h"
 #include "synapse.h"
 #include "solver.h"
+#include "pario.h"
+#include "reorder.h"
 
 typedef struct {
   population_t *u;
@@ -17,7 +19,10 @@ typedef struct {
   conn_t       *c;
   synapse_t    *s;
   FILE *v_dat, *s_dat;
+  pario_output_t *out; // MERGED_OUTPUT == 1
   int *spike;
+  int *gid, *out_order; // gid [ local neuron ] == id in the CSV files and outputs; see REORDER
+  double *v_row; // MERGED_OUTPUT == 1; one row of v in the order of out_order
   int mpi_size, mpi_rank, global_n_neurons;
 } network_t;
 
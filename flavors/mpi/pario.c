@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <mpi.h>
+#include "pario.h"
+#include "config.h"
+
+#define MIN(a,b) ( ( (a) < (b) ) ? (a) : (b) )
+#define MAX_READ_CHUNK ( 1 << 30 ) // MPI counts are int
+
+extern int strip_comment_destructive ( char * );
+
+//
+// Small files (e.g., the population file) are read only once by rank 0 and broadcast,
+// so that 'get_global_n_neurons', 'get_lines' and 'initialize_population' do not hit the file system from every rank.
+// The last file is cached, thus only the first call for each file is collective.
+//
+static char *cache_name = NULL, *cache_buf = NULL;
+static long  cache_size = 0;
+
+FILE *pario_fopen_bcast ( const char *filename )
+{
+  if ( cache_name == NULL || strcmp ( cache_name, filename ) != 0 ) {
+    int mpi_rank; MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
+    long size = -1;
+    char *buf = NULL;
+    if ( mpi_rank == 0 ) {
+      FILE *file = fopen ( filename, "r" );
+      if ( file ) {
+	fseek ( file, 0, SEEK_END );
+	size = ftell ( file );
+	rewind ( file );
+	buf = malloc ( size + 1 );
+	if ( fread ( buf, 1, size, file ) != ( size_t ) size ) { size = -1; }
+	fclose ( file );
+      }
+    }
+    MPI_Bcast ( &size, 1, MPI_LONG, 0, MPI_COMM_WORLD );
+    if ( size < 0 ) { if ( mpi_rank == 0 ) { fprintf ( stderr, "Error: no such file %s\n", filename ); } MPI_Abort ( MPI_COMM_WORLD, 1 ); }
+    if ( mpi_rank != 0 ) { buf = malloc ( size + 1 ); }
+    MPI_Bcast ( buf, ( int ) size, MPI_CHAR, 0, MPI_COMM_WORLD );
+    buf [ size ] = '\0';
+
+    free ( cache_name );
+    free ( cache_buf );
+    cache_name = strdup ( filename );
+    cache_buf  = buf;
+    cache_size = size;
+  }
+
+  FILE *file = fmemopen ( NULL, cache_size + 1, "w+" ); // fmemopen owns and frees its buffer at fclose
+  fwrite ( cache_buf, 1, cache_size, file );
+  rewind ( file );
+  return file;
+}
+
+int pario_get_lines ( const char *filename )
+{
+  FILE *file = pario_fopen_bcast ( filename );
+  char buf [ PARIO_MAX_LINE ];
+  int n = 0;
+  while ( fgets ( buf, PARIO_MAX_LINE, file ) ) {
+    if ( strip_comment_destructive ( buf ) == 0 ) { continue; }
+    n++;
+  }
+  fclose ( file );
+  return n;
+}
+
+//
+// Large files (e.g., the connection file) are split into mpi_size byte ranges and read with collective MPI-IO.
+// A line belongs to the rank whose range contains its first byte.
+// Each rank additionally reads one byte before its range and PARIO_MAX_LINE bytes after it to find the line boundaries.
+//
+char *pario_read_lines ( const char *filename, size_t *size )
+{
+  int mpi_size; MPI_Comm_size ( MPI_COMM_WORLD, &mpi_size );
+  int mpi_rank; MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
+
+  MPI_File fh;
+  if ( MPI_File_open ( MPI_COMM_WORLD, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh ) != MPI_SUCCESS ) {
+    if ( mpi_rank == 0 ) { fprintf ( stderr, "Error: no such file %s\n", filename ); }
+    MPI_Abort ( MPI_COMM_WORLD, 1 );
+  }
+  MPI_Offset file_size;
+  MPI_File_get_size ( fh, &file_size );
+
+  const MPI_Offset chunk = ( file_size + mpi_size - 1 ) / mpi_size;
+  const MPI_Offset begin = MIN ( chunk * mpi_rank, file_size );
+  const MPI_Offset end   = MIN ( begin + chunk, file_size );
+  const MPI_Offset read_begin = ( begin > 0 ) ? begin - 1 : 0;
+  const MPI_Offset read_end   = ( begin < end ) ? MIN ( end + PARIO_MAX_LINE, file_size ) : read_begin;
+  const size_t n_raw = read_end - read_begin;
+
+  char *raw = malloc ( n_raw + 1 );
+  {
+    long n_iter = ( n_raw + MAX_READ_CHUNK - 1 ) / MAX_READ_CHUNK, max_iter;
+    MPI_Allreduce ( &n_iter, &max_iter, 1, MPI_LONG, MPI_MAX, MPI_COMM_WORLD );
+    size_t done = 0;
+    for ( long iter = 0; iter < max_iter; iter++ ) {
+      const int count = ( int ) MIN ( n_raw - done, ( size_t ) MAX_READ_CHUNK );
+      MPI_File_read_at_all ( fh, read_begin + done, raw + done, count, MPI_CHAR, MPI_STATUS_IGNORE );
+      done += count;
+    }
+  }
+  MPI_File_close ( &fh );
+  raw [ n_raw ] = '\0';
+
+  // [ head, tail ) in raw holds the lines of this rank
+  size_t head = begin - read_begin;
+  while ( head > 0 && head < n_raw && raw [ head - 1 ] != '\n' ) { head++; }
+  size_t tail = end - read_begin;
+  if ( tail <= head ) {
+    tail = head;
+  } else {
+    while ( tail < n_raw && raw [ tail - 1 ] != '\n' ) { tail++; }
+    if ( raw [ tail - 1 ] != '\n' && read_begin + tail < file_size ) {
+      fprintf ( stderr, "Error: line longer than %d bytes in %s\n", PARIO_MAX_LINE, filename );
+      MPI_Abort ( MPI_COMM_WORLD, 1 );
+    }
+  }
+
+  memmove ( raw, raw + head, tail - head );
+  raw [ tail - head ] = '\0';
+  *size = tail - head;
+  return raw;
+}
+
+//
+// Merged output: v.bin holds one row of global_n_neurons doubles per time step, and every rank owns fixed columns
+// (consecutive ones unless REORDER == 1) through an indexed file view. s.bin holds ( t_ms, global id ) int pairs;
+// each flush appends the spikes of all ranks in rank order. Rows and spikes are buffered for OUTPUT_BATCH_MS,
+// and the collective writes let the MPI-IO aggregators (OUTPUT_AGGREGATORS, 0 == MPI default) batch the file system traffic.
+//
+typedef struct {
+  char magic [ 8 ];
+  int n_neurons, inv_dt;
+  double dt;
+} output_header_t;
+
+static void open_output_file ( const char *filename, MPI_File *fh )
+{
+  MPI_Info info;
+  MPI_Info_create ( &info );
+  MPI_Info_set ( info, "romio_cb_write", "enable" );
+  if ( OUTPUT_AGGREGATORS > 0 ) {
+    char value [ 32 ];
+    snprintf ( value, sizeof ( value ), "%d", OUTPUT_AGGREGATORS );
+    MPI_Info_set ( info, "cb_nodes", value );
+  }
+  if ( MPI_File_open ( MPI_COMM_WORLD, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, info, fh ) != MPI_SUCCESS ) {
+    fprintf ( stderr, "Error: cannot open %s\n", filename );
+    MPI_Abort ( MPI_COMM_WORLD, 1 );
+  }
+  MPI_Info_free ( &info );
+}
+
+pario_output_t *pario_open_output ( const int global_n_neurons, const int n_local, const int *column ) // column [ local ] == global id, ascending
+{
+  int mpi_rank; MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
+
+  pario_output_t *o = calloc ( 1, sizeof ( pario_output_t ) );
+  o -> n_local  = n_local;
+  o -> max_steps = OUTPUT_BATCH_MS * INV_DT;
+  o -> v_buf = malloc ( ( size_t ) o -> max_steps * ( n_local ? n_local : 1 ) * sizeof ( double ) );
+  o -> max_spikes = 1024;
+  o -> s_buf = malloc ( 2 * o -> max_spikes * sizeof ( int ) );
+
+  if ( mpi_rank == 0 ) { MPI_File_delete ( "v.bin", MPI_INFO_NULL ); MPI_File_delete ( "s.bin", MPI_INFO_NULL ); } // truncate old files; errors are ignored
+  MPI_Barrier ( MPI_COMM_WORLD );
+  open_output_file ( "v.bin", &o -> v_fh );
+  open_output_file ( "s.bin", &o -> s_fh );
+
+  output_header_t h = { .n_neurons = global_n_neurons, .inv_dt = INV_DT, .dt = DT };
+  if ( mpi_rank == 0 ) {
+    memcpy ( h.magic, "NLVOLT01", 8 ); MPI_File_write_at ( o -> v_fh, 0, &h, sizeof ( h ), MPI_BYTE, MPI_STATUS_IGNORE );
+    memcpy ( h.magic, "NLSPIK01", 8 ); MPI_File_write_at ( o -> s_fh, 0, &h, sizeof ( h ), MPI_BYTE, MPI_STATUS_IGNORE );
+  }
+  o -> s_offset = sizeof ( h );
+
+  if ( n_local > 0 ) {
+    const long long n_steps_total = ( long long ) ( TSTOP * INV_DT );
+    MPI_Datatype columns, row, filetype;
+    MPI_Type_create_indexed_block ( n_local, 1, column, MPI_DOUBLE, &columns );
+    MPI_Type_create_resized ( columns, 0, ( MPI_Aint ) global_n_neurons * sizeof ( double ), &row );
+    MPI_Type_contiguous ( n_steps_total, row, &filetype );
+    MPI_Type_commit ( &filetype );
+    MPI_File_set_view ( o -> v_fh, sizeof ( h ), MPI_DOUBLE, filetype, "native", MPI_INFO_NULL );
+    MPI_Type_free ( &filetype );
+    MPI_Type_free ( &row );
+    MPI_Type_free ( &columns );
+  } else {
+    MPI_File_set_view ( o -> v_fh, sizeof ( h ), MPI_DOUBLE, MPI_DOUBLE, "native", MPI_INFO_NULL );
+  }
+  return o;
+}
+
+static void flush_output ( pario_output_t *o ) // collective
+{
+  MPI_File_write_at_all ( o -> v_fh, ( MPI_Offset ) o -> v_step * o -> n_local, o -> v_buf, o -> n_steps * o -> n_local, MPI_DOUBLE, MPI_STATUS_IGNORE );
+  o -> v_step += o -> n_steps;
+  o -> n_steps = 0;
+
+  long long n = o -> n_spikes, before = 0, total = 0;
+  MPI_Exscan ( &n, &before, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD );
+  MPI_Allreduce ( &n, &total, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD );
+  int mpi_rank; MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
+  if ( mpi_rank == 0 ) { before = 0; } // MPI_Exscan leaves rank 0 undefined
+  MPI_File_write_at_all ( o -> s_fh, o -> s_offset + before * 2 * sizeof ( int ), o -> s_buf, 2 * o -> n_spikes, MPI_INT, MPI_STATUS_IGNORE );
+  o -> s_offset += total * 2 * sizeof ( int );
+  o -> n_spikes = 0;
+}
+
+void pario_append_v ( pario_output_t *o, const double *v ) // v [ local neuron ] of one time step
+{
+  memcpy ( &o -> v_buf [ ( size_t ) o -> n_steps * o -> n_local ], v, o -> n_local * sizeof ( double ) );
+  o -> n_steps++;
+  if ( o -> n_steps == o -> max_steps ) { flush_output ( o ); } // every rank reaches here at the same time step
+}
+
+void pario_append_spike ( pario_output_t *o, const int t_ms, const int gid )
+{
+  if ( o -> n_spikes == o -> max_spikes ) { o -> max_spikes *= 2; o -> s_buf = realloc ( o -> s_buf, 2 * o -> max_spikes * sizeof ( int ) ); }
+  o -> s_buf [ 2 * o -> n_spikes + 0 ] = t_ms;
+  o -> s_buf [ 2 * o -> n_spikes + 1 ] = gid;
+  o -> n_spikes++;
+}
+
+void pario_close_output ( pario_output_t *o ) // collective
+{
+  flush_output ( o );
+  MPI_File_close ( &o -> v_fh );
+  MPI_File_close ( &o -> s_fh );
+  free ( o -> v_buf );
+  free ( o -> s_buf );
+  free ( o );
+}
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <mpi.h>
+
+#define PARIO_MAX_LINE ( 1024 ) // same as the line buffers used by the CSV readers
+
+extern FILE *pario_fopen_bcast ( const char * );     // rank 0 reads, all ranks get a copy; collective at the first call for each file
+extern int   pario_get_lines ( const char * );       // get_lines () on the broadcast copy
+extern char *pario_read_lines ( const char *, size_t * ); // collective; whole lines that start in this rank's byte range
+
+// Single global output files written collectively (MERGED_OUTPUT == 1); see helper/merged_output.py for the layout
+typedef struct {
+  MPI_File v_fh, s_fh;
+  int n_local;                 // # local neurons
+  int n_steps, max_steps;      // # buffered / maximum buffered time steps
+  long long v_step;            // # time steps already in the file
+  MPI_Offset s_offset;         // end of s.bin in bytes
+  double *v_buf;               // size == max_steps * n_local, [ step ][ local neuron ]
+  int *s_buf;                  // ( t_ms, global id ) pairs
+  int n_spikes, max_spikes;
+} pario_output_t;
+
+extern pario_output_t *pario_open_output ( const int, const int, const int * ); // # all neurons, # local neurons, global ids of the local columns in ascending order
+extern void pario_append_v ( pario_output_t *, const double * );
+extern void pario_append_spike ( pario_output_t *, const int, const int );
+extern void pario_close_output ( pario_output_t * );
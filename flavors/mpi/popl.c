@@ -8,15 +8,15 @@
 #include "popl.h"
 #include "popl_func.h"
 #include "ion.h"
+#include "pario.h"
 #include "config.h"
 
 #define MIN(a,b) ( ( (a) < (b) ) ? (a) : (b) )
 
-extern int get_lines ( const char * );
 
 int get_global_n_neurons ( const char *filename )
 {
-  int n_popl = get_lines ( filename );
+  int n_popl = pario_get_lines ( filename );
   int n_neuron [ n_popl ], n_comp [ n_popl ];
   get_population_size ( filename, n_popl, n_neuron, n_comp );
 
@@ -26,6 +26,21 @@ int get_global_n_neurons ( const char *filename )
   return global_n_neurons;
 }
 
+int *get_global_population_id ( const char *filename ) // population id of every global neuron
+{
+  int n_popl = pario_get_lines ( filename );
+  int n_neuron [ n_popl ], n_comp [ n_popl ];
+  get_population_size ( filename, n_popl, n_neuron, n_comp );
+
+  int global_n_neurons = 0;
+  for ( int i = 0; i < n_popl; i++ ) { global_n_neurons += n_neuron [ i ]; }
+  int *pid = calloc ( global_n_neurons, sizeof ( int ) );
+  for ( int p = 0, k = 0; p < n_popl; p++ ) {
+    for ( int i = 0; i < n_neuron [ p ]; i++ ) { pid [ k++ ] = p; }
+  }
+  return pid;
+}
+
 static population_t *initialize ( const int n_each, const int n_offset, const int n_popl, const int n_neuron [ ], const int n_comp [ ] )
 {
   int global_n_neurons = 0;
@@ -103,7 +118,7 @@ static population_t *initialize ( const int n_each, const int n_offset, const in
 
 population_t *initialize_population ( const int n_each, const int n_offset, const char *filename )
 {
-  int n_popl = get_lines ( filename );
+  int n_popl = pario_get_lines ( filename );
   int n_neuron [ n_popl ], n_comp [ n_popl ];
   get_population_size ( filename, n_popl, n_neuron, n_comp );
   
@@ -112,8 +127,7 @@ population_t *initialize_population ( const int n_each, const int n_offset, cons
 
   if ( u -> n_popl == 0 ) { return u; }
   
-  FILE *file = fopen ( filename, "r" );
-  if ( ! file ) { fprintf ( stderr, "Error: no such file %s\n", filename ); exit ( 1 ); }
+  FILE *file = pario_fopen_bcast ( filename );
 
   int pid = 0;
   char buf [ 1024 ];
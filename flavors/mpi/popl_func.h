@@ -6,6 +6,7 @@
 #include <assert.h>
 #include "popl.h"
 #include "ion.h"
+#include "pario.h"
 #include "config.h"
 
 #define MAX_N_COMP ( 16384 )
@@ -150,8 +151,7 @@ static segment_tree_t *read_in_neuron_style ( const char *filename, const int n_
 
 static void get_population_size ( const char *filename, const int n_popl, int n_neuron [ n_popl ], int n_comp [ n_popl ] )
 {
-  FILE *file = fopen ( filename, "r" );
-  if ( ! file ) { fprintf ( stderr, "Error: no such file %s\n", filename ); exit ( 1 ); }
+  FILE *file = pario_fopen_bcast ( filename );
   int i = 0;
   char buf [ 1024 ];
   while ( fgets ( buf, 1024, file ) ) {
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include <mpi.h>
+#include "conn.h"
+#include "reorder.h"
+#include "config.h"
+
+extern int *get_global_population_id ( const char * );
+
+static const int *sort_degree;
+static int compare_degree ( const void *a, const void *b )
+{
+  const int i = *( const int * ) a, j = *( const int * ) b;
+  const int di = sort_degree [ i ], dj = sort_degree [ j ];
+  return ( di != dj ) ? ( di > dj ) - ( di < dj ) : ( i > j ) - ( i < j );
+}
+
+//
+// Reverse Cuthill-McKee ordering of the connection graph (directions are ignored).
+// Connected neurons get close positions, so the targets of a spike are close in memory and mostly on the same rank.
+// edge [ 2 * k ] and edge [ 2 * k + 1 ] are the pre and post neurons of the k-th connection.
+// Returns order [ position ] = neuron.
+//
+static int *rcm ( const int n_neuron, const long n_edge, const int *edge )
+{
+  int *degree = calloc ( n_neuron, sizeof ( int ) );
+  for ( long k = 0; k < n_edge; k++ ) {
+    const int a = edge [ 2 * k ], b = edge [ 2 * k + 1 ];
+    if ( a != b ) { degree [ a ]++; degree [ b ]++; }
+  }
+  long *ptr = calloc ( n_neuron + 1, sizeof ( long ) );
+  for ( int i = 0; i < n_neuron; i++ ) { ptr [ i + 1 ] = ptr [ i ] + degree [ i ]; }
+  int *adj = malloc ( ( ptr [ n_neuron ] ? ptr [ n_neuron ] : 1 ) * sizeof ( int ) );
+  {
+    long *pos = malloc ( ( n_neuron ? n_neuron : 1 ) * sizeof ( long ) );
+    for ( int i = 0; i < n_neuron; i++ ) { pos [ i ] = ptr [ i ]; }
+    for ( long k = 0; k < n_edge; k++ ) {
+      const int a = edge [ 2 * k ], b = edge [ 2 * k + 1 ];
+      if ( a != b ) { adj [ pos [ a ]++ ] = b; adj [ pos [ b ]++ ] = a; }
+    }
+    free ( pos );
+  }
+
+  // Neighbors and start neurons are visited in ascending degree
+  sort_degree = degree;
+  for ( int i = 0; i < n_neuron; i++ ) { qsort ( &adj [ ptr [ i ] ], ptr [ i + 1 ] - ptr [ i ], sizeof ( int ), compare_degree ); }
+  int *start = malloc ( ( n_neuron ? n_neuron : 1 ) * sizeof ( int ) );
+  for ( int i = 0; i < n_neuron; i++ ) { start [ i ] = i; }
+  qsort ( start, n_neuron, sizeof ( int ), compare_degree );
+
+  // Breadth-first search from each unvisited neuron of the lowest degree; order doubles as the queue
+  int *order = malloc ( ( n_neuron ? n_neuron : 1 ) * sizeof ( int ) );
+  char *visited = calloc ( n_neuron, sizeof ( char ) );
+  int head = 0, tail = 0;
+  for ( int s = 0; s < n_neuron; s++ ) {
+    if ( visited [ start [ s ] ] ) { continue; }
+    visited [ start [ s ] ] = 1;
+    order [ tail++ ] = start [ s ];
+    while ( head < tail ) {
+      const int v = order [ head++ ];
+      for ( long j = ptr [ v ]; j < ptr [ v + 1 ]; j++ ) {
+	if ( ! visited [ adj [ j ] ] ) { visited [ adj [ j ] ] = 1; order [ tail++ ] = adj [ j ]; }
+      }
+    }
+  }
+  assert ( tail == n_neuron );
+  for ( int i = 0; i < n_neuron / 2; i++ ) { const int t = order [ i ]; order [ i ] = order [ n_neuron - 1 - i ]; order [ n_neuron - 1 - i ] = t; }
+
+  free ( visited );
+  free ( start );
+  free ( adj );
+  free ( ptr );
+  free ( degree );
+  return order;
+}
+
+static int compare_pair ( const void *a, const void *b )
+{
+  const int *p = a, *q = b;
+  return ( p [ 0 ] != q [ 0 ] ) ? ( p [ 0 ] > q [ 0 ] ) - ( p [ 0 ] < q [ 0 ] ) : ( p [ 1 ] > q [ 1 ] ) - ( p [ 1 ] < q [ 1 ] );
+}
+
+//
+// Rank 0 orders all neurons, so it holds the connection graph: each rank sends its distinct ( pre, post ) pairs,
+// which are far fewer than the connections, since a pair of neurons is usually connected by several synapses.
+// Rank 0 needs about 16 bytes per distinct pair and 40 bytes per neuron, and the pairs are counted in int (MPI).
+//
+int *reorder_neurons ( const int global_n_neurons, const char *population_file, const conn_record_t *records, const long n_records )
+{
+  int mpi_size; MPI_Comm_size ( MPI_COMM_WORLD, &mpi_size );
+  int mpi_rank; MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
+
+  // Distinct pairs of this rank; self-connections do not matter to the ordering
+  int *local = malloc ( ( n_records ? 2 * n_records : 1 ) * sizeof ( int ) );
+  long n_pair = 0;
+  for ( long r = 0; r < n_records; r++ ) {
+    const int pre = records [ r ].pre, post = records [ r ].post_i;
+    if ( pre < 0 || pre >= global_n_neurons || post < 0 || post >= global_n_neurons ) {
+      fprintf ( stderr, "Error: connection %d -> %d refers to a neuron out of 0..%d\n", pre, post, global_n_neurons - 1 ); MPI_Abort ( MPI_COMM_WORLD, 1 );
+    }
+    if ( pre != post ) { local [ 2 * n_pair + 0 ] = pre; local [ 2 * n_pair + 1 ] = post; n_pair++; }
+  }
+  qsort ( local, n_pair, 2 * sizeof ( int ), compare_pair );
+  long n_local = 0;
+  for ( long k = 0; k < n_pair; k++ ) {
+    if ( n_local > 0 && compare_pair ( &local [ 2 * k ], &local [ 2 * ( n_local - 1 ) ] ) == 0 ) { continue; }
+    local [ 2 * n_local + 0 ] = local [ 2 * k + 0 ]; local [ 2 * n_local + 1 ] = local [ 2 * k + 1 ]; n_local++;
+  }
+
+  long n_total = 0;
+  MPI_Reduce ( &n_local, &n_total, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD );
+  int too_many = ( mpi_rank == 0 && n_total > INT_MAX );
+  MPI_Bcast ( &too_many, 1, MPI_INT, 0, MPI_COMM_WORLD );
+  if ( too_many ) {
+    if ( mpi_rank == 0 ) { fprintf ( stderr, "Error: REORDER supports up to %d distinct pairs of connected neurons, but there are %ld\n", INT_MAX, n_total ); }
+    MPI_Abort ( MPI_COMM_WORLD, 1 );
+  }
+
+  MPI_Datatype pair_type;
+  MPI_Type_contiguous ( 2, MPI_INT, &pair_type );
+  MPI_Type_commit ( &pair_type );
+  const int n_send = n_local;
+  int *counts = NULL, *displs = NULL, *edge = NULL;
+  const long n_edge = n_total;
+  if ( mpi_rank == 0 ) {
+    counts = calloc ( mpi_size, sizeof ( int ) );
+    displs = calloc ( mpi_size, sizeof ( int ) );
+    edge = malloc ( ( n_edge ? 2 * n_edge : 1 ) * sizeof ( int ) );
+    if ( edge == NULL ) { fprintf ( stderr, "Error: REORDER cannot allocate %ld distinct pairs on rank 0\n", n_edge ); MPI_Abort ( MPI_COMM_WORLD, 1 ); }
+  }
+  MPI_Gather ( &n_send, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD );
+  if ( mpi_rank == 0 ) { for ( int i = 1; i < mpi_size; i++ ) { displs [ i ] = displs [ i - 1 ] + counts [ i - 1 ]; } }
+  MPI_Gatherv ( local, n_send, pair_type, edge, counts, displs, pair_type, 0, MPI_COMM_WORLD );
+  MPI_Type_free ( &pair_type );
+  free ( local );
+
+  int *new_id = calloc ( global_n_neurons, sizeof ( int ) );
+  int *pid = get_global_population_id ( population_file ); // collective
+  if ( mpi_rank == 0 ) {
+    int *order = rcm ( global_n_neurons, n_edge, edge );
+
+    // Populations must stay contiguous, so neurons are renumbered within their own population in the RCM order
+    int *next = calloc ( pid [ global_n_neurons - 1 ] + 1, sizeof ( int ) ); // next [ pid ] == next free id in the population
+    for ( int i = global_n_neurons - 1; i >= 0; i-- ) { next [ pid [ i ] ] = i; }
+    for ( int k = 0; k < global_n_neurons; k++ ) {
+      const int i = order [ k ];
+      new_id [ i ] = next [ pid [ i ] ]++;
+    }
+    free ( next );
+    free ( order );
+    free ( edge );
+    free ( counts );
+    free ( displs );
+  }
+  free ( pid );
+  MPI_Bcast ( new_id, global_n_neurons, MPI_INT, 0, MPI_COMM_WORLD );
+
+  return new_id;
+}
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#pragma once
+
+#include "conn.h"
+
+extern int *reorder_neurons ( const int, const char *, const conn_record_t *, const long ); // collective; new_id [ global id in the CSV files ] for all neurons, from the records of read_connection
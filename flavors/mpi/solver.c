@@ -12,6 +12,7 @@
 #include "synapse.h"
 #include "solver.h"
 #include "hines.h"
+#include "timer.h"
 #include "config.h"
 //#include <omp.h>
 
@@ -25,9 +26,19 @@ solver_t *initialize_solver ( const population_t *u )
   int n_neuron = 0; for ( int i = 0; i < n_popl; i++ ) { n_neuron += u -> n_neuron [ i ]; }
   
   solver_t *solver = calloc ( 1, sizeof ( solver_t ) );
-  solver -> linsys = calloc ( n_neuron, sizeof ( linsys_t ) );
   solver -> n_popl = n_popl;
   solver -> n_neuron = n_neuron;
+  solver -> H = calloc ( n_popl, sizeof ( hines_matrix_t * ) );
+
+  // Arena: linsys, then the hines_matrix_t, Ad and b of each neuron in the order of the neuron ids
+  size_t size = ARENA_SIZE ( n_neuron, sizeof ( linsys_t ) );
+  for ( int pid = 0; pid < n_popl; pid++ ) {
+    size += u -> n_neuron [ pid ] * ( ARENA_SIZE ( 1, sizeof ( hines_matrix_t ) ) + 2 * ARENA_SIZE ( u -> n_comp [ pid ], sizeof ( double ) ) );
+  }
+  solver -> arena = initialize_arena ( size );
+  solver -> linsys = arena_alloc ( solver -> arena, n_neuron, sizeof ( linsys_t ) );
+  int *popl   = calloc ( n_neuron, sizeof ( int ) );      // population of each neuron and
+  double **Ad = calloc ( n_neuron, sizeof ( double * ) ); // its Ad, until the blocks are filled below
 
   int offset = 0;
   for ( int pid = 0; pid < n_popl; pid++ ) {
@@ -60,23 +71,44 @@ solver_t *initialize_solver ( const population_t *u )
       }
     }
 
+    // The morphology, Api and bu_Ad are the same for all neurons of the population
+    hines_matrix_t *H = solver -> H [ pid ] = hines_matrix_initialize ( u, pid );
+    for ( int i = 0; i < n_comp; i++ ) {
+      const int parent_id = H -> parent_id [ i ];
+      H -> Ad     [ i ] = mat [ i + n_comp * i ];
+      H -> Api    [ i ] = ( parent_id >= 0 ) ? -mat [ parent_id + n_comp * i ] : 0; // never modified by the solvers
+      H -> bu_Ad  [ i ] = mat [ i + n_comp * i ];
+      H -> bu_Api [ i ] = ( parent_id >= 0 ) ? -mat [ parent_id + n_comp * i ] : 0;
+    }
+
+    // Only the addresses here; the blocks are not written, so that their pages stay untouched
     for ( int li = 0; li < u -> n_neuron [ pid ]; li++ ) {
       linsys_t *s = &solver -> linsys [ offset + li ];
-      s -> H = hines_matrix_initialize( u, pid );
-      for ( int i = 0; i < n_comp; i++ ) {
-	const int parent_id = s -> H -> parent_id [ i ];
-	s -> H -> Ad     [ i ] = mat [ i + n_comp * i ];
-	s -> H -> Api    [ i ] = ( parent_id >= 0 ) ? -mat [ parent_id + n_comp * i ] : 0;
-	s -> H -> bu_Ad  [ i ] = mat [ i + n_comp * i ];
-	s -> H -> bu_Api [ i ] = ( parent_id >= 0 ) ? -mat [ parent_id + n_comp * i ] : 0;
-      }
-      s -> b = calloc ( n_comp, sizeof ( double ) ); // b value
+      popl [ offset + li ] = pid;
+      s -> H            = arena_alloc ( solver -> arena, 1, sizeof ( hines_matrix_t ) );
+      Ad [ offset + li ] = arena_alloc ( solver -> arena, n_comp, sizeof ( double ) );
+      s -> b            = arena_alloc ( solver -> arena, n_comp, sizeof ( double ) ); // b value
     }
 
     offset += u -> n_neuron [ pid ];
     free ( mat );
   }
 
+  // This loop is the first touch of the blocks of each neuron. Its static schedule is the one of the neuron loop
+  // in solve_network, so that the pages of a neuron are placed on the NUMA node of the thread that solves it.
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( static )
+#endif
+  for ( int id = 0; id < n_neuron; id++ ) {
+    linsys_t *s = &solver -> linsys [ id ];
+    const hines_matrix_t *H = solver -> H [ popl [ id ] ];
+    *s -> H = *H;
+    s -> H -> Ad = Ad [ id ];
+    for ( int i = 0; i < H -> n_comp; i++ ) { s -> H -> Ad [ i ] = H -> Ad [ i ]; s -> b [ i ] = 0.0; }
+  }
+  free ( popl );
+  free ( Ad );
+
   return solver;
 }
 
@@ -92,7 +124,7 @@ static void update_matrix ( const int id, const population_t * __restrict__ u, c
   const double *v_leak = &u -> vl [ u -> cid [ pid ] ];
   const int n_comp = u -> n_comp [ pid ];
 
-  for ( int li = 0; li < linsys -> H -> n_comp; li++ ) { linsys -> H -> Ad [ li ] = linsys -> H -> bu_Ad [ li ]; linsys -> H  -> Api [ li ] = linsys -> H -> bu_Api[ li ]; }
+  for ( int li = 0; li < linsys -> H -> n_comp; li++ ) { linsys -> H -> Ad [ li ] = linsys -> H -> bu_Ad [ li ]; } // Api is shared and never modified
 
   for ( int li = 0; li < n_comp; li++ ) {
     linsys -> H -> Ad[ li ] += ( cm [ li ] / dt ) + g_leak [ li ];
@@ -200,23 +232,32 @@ void solve ( const int id, const population_t * __restrict__ u, neuron_t * __res
   const int n_comp = u -> n_comp [ pid ];
   linsys_t *linsys = &solver -> linsys [ id ];
 
+  TIMER_BEGIN ( t0 );
   update_synapse ( id, c, s );
+  TIMER_END ( t0, T_SYNAPSE, pid );
+  TIMER_BEGIN ( t1 );
   update_matrix ( id, u, n, i, c, s, linsys, 0.5*DT );
+  TIMER_END ( t1, T_MATRIX, pid );
+  TIMER_BEGIN ( t2 );
   solve_matrix ( linsys );
+  TIMER_END ( t2, T_SOLVE, pid );
+  TIMER_BEGIN ( t3 );
   update_ca ( id, u, i, n, 0.5*DT );
   update_ion ( id, n, linsys -> b, i, DT );
   update_ca ( id, u, i, n, 0.5*DT );
+  TIMER_END ( t3, T_ION, pid );
+  TIMER_BEGIN ( t4 );
   for ( int j = 0; j < n_comp; j++ ) { n -> v [ sid + j ] = 2 * linsys -> b [ j ] - n -> v [ sid + j ]; }
+  TIMER_END ( t4, T_SOLVE, pid );
 }
 
 void finalize_solver ( solver_t *solver )
 {
-  for ( int i = 0; i < solver -> n_neuron; i++ ) {
-    linsys_t *s = &solver -> linsys [ i ];
-    hines_matrix_finalize ( s -> H );
-    free ( s -> H );
-    free ( s -> b );
+  for ( int pid = 0; pid < solver -> n_popl; pid++ ) {
+    hines_matrix_finalize ( solver -> H [ pid ] );
+    free ( solver -> H [ pid ] );
   }
-  free ( solver -> linsys );
+  free ( solver -> H );
+  finalize_arena ( solver -> arena ); // linsys, and Ad and b of the neurons
   free ( solver );
 }
@@ -8,6 +8,7 @@
 #include "conn.h"
 #include "synapse.h"
 #include "hines.h"
+#include "arena.h"
 
 typedef struct {
   hines_matrix_t *H;
@@ -16,6 +17,8 @@ typedef struct {
 
 typedef struct {
   linsys_t *linsys;
+  hines_matrix_t **H; // size == # populations; parent_id, Api and bu_Ad, shared by the linsys -> H of the neurons of the population
+  arena_t *arena;     // linsys, and per neuron linsys -> H, its Ad and b
   int n_popl, n_neuron;
 } solver_t;
 
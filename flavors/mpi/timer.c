@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <mpi.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "popl.h"
+#include "timer.h"
+#include "config.h"
+
+static const char *phase_name [ N_TIMER ] = { "update_synapse", "update_matrix", "solve_matrix", "update_ion_ca", "spike_detection", "spike_propagation", "output", "mpi_wait" };
+
+//
+// acc [ thread ][ phase ][ global pid + 1 ]; slot 0 is for time that belongs to no population.
+// Each thread has its own row, so timer_add needs no synchronization.
+//
+static double *acc = NULL;
+static int n_thread = 1, n_slot = 1, pid_offset = 0, mpi_rank = 0, mpi_size = 1;
+static int *slot_n_neuron = NULL, *slot_n_comp = NULL; // of this rank
+static double progress_start = 0.0, progress_last = 0.0;
+
+double timer_now ( void )
+{
+  struct timespec ts;
+  clock_gettime ( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec + ( double ) ts.tv_nsec * 1.0e-9;
+}
+
+void timer_initialize ( const population_t *u )
+{
+#ifdef _OPENMP
+  n_thread = omp_get_max_threads ( );
+#endif
+  MPI_Comm_rank ( MPI_COMM_WORLD, &mpi_rank );
+  MPI_Comm_size ( MPI_COMM_WORLD, &mpi_size );
+
+  // Populations are numbered globally, so that the ranks can be reduced slot by slot
+  pid_offset = ( u -> n_popl > 0 ) ? u -> start_pid : 0;
+  int n_popl = pid_offset + u -> n_popl;
+  MPI_Allreduce ( MPI_IN_PLACE, &n_popl, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD );
+  n_slot = n_popl + 1;
+  slot_n_neuron = calloc ( n_slot, sizeof ( int ) );
+  slot_n_comp   = calloc ( n_slot, sizeof ( int ) );
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) {
+    slot_n_neuron [ pid_offset + pid + 1 ] = u -> n_neuron [ pid ];
+    slot_n_comp   [ pid_offset + pid + 1 ] = u -> n_comp   [ pid ];
+  }
+
+  acc = calloc ( n_thread * N_TIMER * n_slot, sizeof ( double ) );
+  progress_start = progress_last = timer_now ( );
+}
+
+void timer_add ( const int phase, const int pid, const double sec )
+{
+#ifdef _OPENMP
+  const int thread = omp_get_thread_num ( );
+#else
+  const int thread = 0;
+#endif
+  const int slot = ( pid < 0 ) ? 0 : pid_offset + pid + 1;
+  acc [ slot + n_slot * ( phase + N_TIMER * thread ) ] += sec;
+}
+
+void timer_progress ( const int t_ms )
+{
+  if ( mpi_rank != 0 ) { return; }
+  const double now = timer_now ( );
+  if ( t_ms > 0 && now - progress_last < PROGRESS_INTERVAL ) { return; }
+  fprintf ( stderr, "t = %d ms (%.2f ms/s)\n", t_ms, ( now > progress_start ) ? t_ms / ( now - progress_start ) : 0.0 );
+  progress_last = now;
+}
+
+void timer_finalize ( const double elapsed )
+{
+  if ( PROFILE == 1 ) {
+    // Sum over threads; phase [ N_TIMER ][ n_slot ]
+    double *phase = calloc ( N_TIMER * n_slot, sizeof ( double ) );
+    for ( int t = 0; t < n_thread; t++ ) {
+      for ( int k = 0; k < N_TIMER * n_slot; k++ ) { phase [ k ] += acc [ k + N_TIMER * n_slot * t ]; }
+    }
+    // spike_detection is measured as the whole loop over a neuron; the phases inside solve are subtracted
+    for ( int p = 0; p < n_slot; p++ ) {
+      for ( int k = T_SYNAPSE; k <= T_ION; k++ ) { phase [ p + n_slot * T_SPIKE ] -= phase [ p + n_slot * k ]; }
+      if ( phase [ p + n_slot * T_SPIKE ] < 0.0 ) { phase [ p + n_slot * T_SPIKE ] = 0.0; }
+    }
+    // likewise, spike_propagation includes the collectives
+    phase [ n_slot * T_PROPAGATION ] -= phase [ n_slot * T_MPI_WAIT ];
+    if ( phase [ n_slot * T_PROPAGATION ] < 0.0 ) { phase [ n_slot * T_PROPAGATION ] = 0.0; }
+    double total [ N_TIMER ];
+    for ( int k = 0; k < N_TIMER; k++ ) {
+      total [ k ] = 0.0;
+      for ( int p = 0; p < n_slot; p++ ) { total [ k ] += phase [ p + n_slot * k ]; }
+    }
+
+    // Ranks: the maximum shows the slowest rank of each phase, the sum the total work
+    double total_max [ N_TIMER ], total_sum [ N_TIMER ];
+    MPI_Reduce ( total, total_max, N_TIMER, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD );
+    MPI_Reduce ( total, total_sum, N_TIMER, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD );
+    double *phase_sum = calloc ( N_TIMER * n_slot, sizeof ( double ) );
+    MPI_Reduce ( phase, phase_sum, N_TIMER * n_slot, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD );
+    int *n_neuron = calloc ( n_slot, sizeof ( int ) ), *n_comp = calloc ( n_slot, sizeof ( int ) );
+    MPI_Reduce ( slot_n_neuron, n_neuron, n_slot, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD );
+    MPI_Reduce ( slot_n_comp,   n_comp,   n_slot, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD );
+
+    if ( mpi_rank == 0 ) {
+      fprintf ( stderr, "%-18s %12s %12s %7s\n", "phase", "max [s]", "sum [s]", "[%]" );
+      for ( int k = 0; k < N_TIMER; k++ ) {
+	fprintf ( stderr, "%-18s %12.3f %12.3f %7.2f\n", phase_name [ k ], total_max [ k ], total_sum [ k ],
+		  ( elapsed > 0.0 ) ? 100.0 * total_sum [ k ] / ( elapsed * n_thread * mpi_size ) : 0.0 );
+      }
+
+      FILE *file = fopen ( "profile.json", "w" );
+      if ( ! file ) { fprintf ( stderr, "Error: cannot open profile.json\n" ); MPI_Abort ( MPI_COMM_WORLD, 1 ); }
+      fprintf ( file, "{\n  \"tstop\": %f,\n  \"dt\": %f,\n  \"ranks\": %d,\n  \"threads\": %d,\n  \"elapsed\": %f,\n", ( double ) TSTOP, DT, mpi_size, n_thread, elapsed );
+      fprintf ( file, "  \"phases_max\": {" );
+      for ( int k = 0; k < N_TIMER; k++ ) { fprintf ( file, "%s\"%s\": %f", ( k == 0 ) ? " " : ", ", phase_name [ k ], total_max [ k ] ); }
+      fprintf ( file, " },\n  \"phases_sum\": {" );
+      for ( int k = 0; k < N_TIMER; k++ ) { fprintf ( file, "%s\"%s\": %f", ( k == 0 ) ? " " : ", ", phase_name [ k ], total_sum [ k ] ); }
+      fprintf ( file, " },\n  \"populations\": [\n" );
+      for ( int pid = 0; pid < n_slot - 1; pid++ ) {
+	fprintf ( file, "    { \"pid\": %d, \"n_neuron\": %d, \"n_comp\": %d, \"phases_sum\": {", pid, n_neuron [ pid + 1 ], n_comp [ pid + 1 ] );
+	for ( int k = 0; k < N_TIMER; k++ ) { fprintf ( file, "%s\"%s\": %f", ( k == 0 ) ? " " : ", ", phase_name [ k ], phase_sum [ ( pid + 1 ) + n_slot * k ] ); }
+	fprintf ( file, " } }%s\n", ( pid == n_slot - 2 ) ? "" : "," );
+      }
+      fprintf ( file, "  ]\n}\n" );
+      fclose ( file );
+    }
+    free ( n_comp );
+    free ( n_neuron );
+    free ( phase_sum );
+    free ( phase );
+  }
+  free ( slot_n_comp );
+  free ( slot_n_neuron );
+  free ( acc );
+  acc = NULL;
+}
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#pragma once
+
+#include "popl.h"
+#include "config.h"
+
+typedef enum { T_SYNAPSE, T_MATRIX, T_SOLVE, T_ION, T_SPIKE, T_PROPAGATION, T_OUTPUT, T_MPI_WAIT, N_TIMER } timer_phase_t;
+
+// Accumulate the time between TIMER_BEGIN and TIMER_END to a phase of a population (-1 == no population).
+// Both expand to nothing unless PROFILE == 1.
+#if PROFILE == 1
+#define TIMER_BEGIN(t0) const double t0 = timer_now ( )
+#define TIMER_END(t0, phase, pid) timer_add ( ( phase ), ( pid ), timer_now ( ) - ( t0 ) )
+#else
+#define TIMER_BEGIN(t0)
+#define TIMER_END(t0, phase, pid)
+#endif
+
+extern double timer_now ( void );
+extern void timer_initialize ( const population_t * );
+extern void timer_add ( const int, const int, const double );
+extern void timer_progress ( const int );  // rate-limited progress line on rank 0, every PROGRESS_INTERVAL seconds
+extern void timer_finalize ( const double ); // collective; report and profile.json on rank 0 (PROFILE == 1); the argument is the elapsed time
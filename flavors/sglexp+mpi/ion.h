@@ -22,6 +22,6 @@ typedef struct {
 
 extern ion_t *initialize_ion ( const neuron_t * );
 extern void finalize_ion ( ion_t * );
-extern void update_ion ( const int, const neuron_t *, const double *, ion_t *, const double );
+extern void update_ion ( const int, const neuron_t *, ion_t *, const double );
 extern void update_ca ( const int, const population_t *, const ion_t *, neuron_t *, const double );
 extern void calc_lhs_and_rhs ( const population_t *, const neuron_t *, const ion_t *, const int, const int, double *, double * );
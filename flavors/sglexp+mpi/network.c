@@ -101,6 +101,18 @@ void spike_detection ( network_t *net )
   }
 }
 
+static int find_pre ( const conn_t *c, const int pre ) // binary search in the sorted pre_table; -1 if not found
+{
+  int lo = 0, hi = c -> n_pre - 1;
+  while ( lo <= hi ) {
+    const int mid = lo + ( hi - lo ) / 2;
+    if      ( c -> pre_table [ mid ] < pre ) { lo = mid + 1; }
+    else if ( c -> pre_table [ mid ] > pre ) { hi = mid - 1; }
+    else { return mid; }
+  }
+  return -1;
+}
+
 void spike_propagation ( const double t, network_t *net )
 {
   if ( net -> tick % net -> inv_dt == 0 ) {
@@ -152,20 +164,17 @@ void spike_propagation ( const double t, network_t *net )
     //
     // Spike propagation
     //
+    // Each connection has exactly one presynaptic neuron, so spiking neurons can be delivered in parallel.
     const conn_t *c = net -> c;
     synapse_t *s = net -> s;
-    int neuron_idx = 0, table_idx = 0;
-    while ( neuron_idx < size_spiking_neurons && table_idx < c -> n_pre ) {
-      if        ( spiking_neurons [ neuron_idx ] < c -> pre_table [ table_idx ] ) {
-	neuron_idx++;
-      } else if ( spiking_neurons [ neuron_idx ] > c -> pre_table [ table_idx ] ) {
-	table_idx++;
-      } else {
-	for ( int j = c -> ptr_pre [ table_idx ]; j < c -> ptr_pre [ table_idx + 1 ]; j++ ) {
-	  s -> delay [ c -> id [ j ] ] = ( 1 << c -> delay [ j ] );
-	}
-	table_idx++;
-	neuron_idx++;
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic, 16 )
+#endif
+    for ( int neuron_idx = 0; neuron_idx < size_spiking_neurons; neuron_idx++ ) {
+      const int table_idx = find_pre ( c, spiking_neurons [ neuron_idx ] );
+      if ( table_idx < 0 ) { continue; }
+      for ( int j = c -> ptr_pre [ table_idx ]; j < c -> ptr_pre [ table_idx + 1 ]; j++ ) {
+	s -> delay [ c -> id [ j ] ] = ( 1 << c -> delay [ j ] );
       }
     }
     free ( spiking_neurons );
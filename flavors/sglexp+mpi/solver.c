@@ -197,7 +197,9 @@ void solve ( const population_t * __restrict__ u, neuron_t * __restrict__ n, ion
 {
   update_synapse ( c, s );
 
-  //#pragma omp parallel for
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( dynamic )
+#endif
   for ( int li = 0; li < n -> n_neuron; li++ ) {
     const int sid = n -> sid [ li ];
     const int pid = n -> pid [ li ];
@@ -29,11 +29,17 @@ void finalize_synapse ( synapse_t *s )
 
 void update_synapse ( const conn_t * __restrict__ c, synapse_t * __restrict__ s )
 {
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( static )
+#endif
   for ( int i = 0; i < c -> n_conn; i++ ) { s -> sum0 [ i ] *= c -> decay [ i ]; }
 }
 
 void add_spike_to_synapse_per_ms ( const conn_t * __restrict__ c, synapse_t * __restrict__ s ) // each 1 ms
 {
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( static )
+#endif
   for ( int i = 0; i < c -> n_conn; i++ ) {
     s -> delay [ i ] >>= 1;
     s -> sum0 [ i ] += ( s -> delay [ i ] == 1 ) ? 1 : 0;
@@ -0,0 +1,353 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0-only
+# Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+"""Generate the C kernels of the Hodgkin-Huxley channels (kernel/ion_gen.h) from a kinetic description.
+
+usage: gen_channels.py channels.json > ion_gen.h
+
+Each channel of the description has constants (const), and gates with a steady state (inf) and a time
+constant (tau) written as Python expressions of v and ca; a gate may define named subexpressions (let).
+For every channel the generator emits
+
+  rate_<channel>_exact    inf and tau of all gates at once; constants are folded to literals and the
+                          subexpressions shared between the gates, inf and tau are computed once
+  rate_<channel>          rate_<channel>_exact, or linear interpolation of a table when ION_LUT == 1
+  rate_<channel>_batch    the same over n compartments, structure of arrays (inf [ gate * n + k ])
+  inf_<gate>, tau_<gate>  single values, e.g. for initialization
+
+and update_gates / init_gates, which advance / initialize the state of every channel in a mask, and
+update_gates_comp, which advances the gates of the compartments that have each channel (ALLACTIVE == 1).
+Each expression is evaluated in the same order as written, so the results are identical to plain C code of
+the same expressions.
+"""
+
+import ast
+import json
+import math
+import sys
+
+FUNCS = {"exp": math.exp, "pow": math.pow, "log": math.log, "fabs": math.fabs}
+C_FUNCS = set(FUNCS) | {"vtrap"}
+OPS = {ast.Add: "+", ast.Sub: "-", ast.Mult: "*", ast.Div: "/"}
+CMPS = {ast.Lt: "<", ast.LtE: "<=", ast.Gt: ">", ast.GtE: ">="}
+
+
+def error(msg):
+    sys.exit(f"gen_channels.py: {msg}")
+
+
+class Substitute(ast.NodeTransformer):
+    """Replace names by expressions (lets and constants)."""
+
+    def __init__(self, table):
+        self.table = table
+
+    def visit_Name(self, node):
+        return self.table[node.id] if node.id in self.table else node
+
+
+def parse(text, table):
+    tree = ast.parse(text, mode="eval").body
+    return fold(Substitute(table).visit(tree))
+
+
+def value(node):
+    return node.value if isinstance(node, ast.Constant) else None
+
+
+def fold(node):
+    """Fold constant subtrees without reassociation, so that C computes the same values."""
+    for field, child in ast.iter_fields(node):
+        if isinstance(child, ast.AST):
+            setattr(node, field, fold(child))
+        elif isinstance(child, list):
+            setattr(node, field, [fold(c) if isinstance(c, ast.AST) else c for c in child])
+    if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.USub) and value(node.operand) is not None:
+        return ast.Constant(-float(node.operand.value))
+    if isinstance(node, ast.BinOp) and value(node.left) is not None and value(node.right) is not None:
+        a, b = float(node.left.value), float(node.right.value)
+        return ast.Constant({ast.Add: a + b, ast.Sub: a - b, ast.Mult: a * b, ast.Div: a / b}[type(node.op)])
+    if isinstance(node, ast.Call) and node.func.id in FUNCS and all(value(a) is not None for a in node.args):
+        return ast.Constant(FUNCS[node.func.id](*[float(a.value) for a in node.args]))
+    return node
+
+
+def check(node, where):
+    for n in ast.walk(node):
+        if isinstance(n, ast.Name) and n.id not in ("v", "ca") and n.id not in C_FUNCS:
+            error(f"{where}: unknown name {n.id}")
+        if isinstance(n, ast.Call) and (not isinstance(n.func, ast.Name) or n.func.id not in C_FUNCS):
+            error(f"{where}: unknown function {ast.unparse(n.func)}")
+        if isinstance(n, (ast.BinOp)) and type(n.op) not in OPS:
+            error(f"{where}: unsupported operator in {ast.unparse(n)}")
+
+
+def uses_ca(nodes):
+    return any(isinstance(n, ast.Name) and n.id == "ca" for node in nodes for n in ast.walk(node))
+
+
+class Emitter:
+    """Emit C expressions; subtrees that occur more than once are computed once into temporaries."""
+
+    def __init__(self, roots):
+        self.count = {}
+        for root in roots:
+            self.tally(root)
+        self.temp = {}
+        self.lines = []
+
+    def tally(self, node):
+        if isinstance(node, (ast.BinOp, ast.Call, ast.IfExp)):
+            key = ast.dump(node)
+            self.count[key] = self.count.get(key, 0) + 1
+        for child in ast.iter_child_nodes(node):
+            self.tally(child)
+
+    def expr(self, node):
+        key = ast.dump(node)
+        if key in self.temp:
+            return self.temp[key]
+        if isinstance(node, ast.Constant):
+            text = repr(float(node.value))
+            return f"( {text} )" if text.startswith("-") else text
+        if isinstance(node, ast.Name):
+            return node.id
+        if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.USub):
+            text = f"- {self.expr(node.operand)}"
+        elif isinstance(node, ast.BinOp):
+            text = f"( {self.expr(node.left)} {OPS[type(node.op)]} {self.expr(node.right)} )"
+        elif isinstance(node, ast.Call):
+            text = f"{node.func.id} ( {', '.join(self.expr(a) for a in node.args)} )"
+        elif isinstance(node, ast.IfExp):
+            t = node.test
+            if not isinstance(t, ast.Compare) or len(t.ops) != 1 or type(t.ops[0]) not in CMPS:
+                error(f"unsupported condition {ast.unparse(t)}")
+            cond = f"{self.expr(t.left)} {CMPS[type(t.ops[0])]} {self.expr(t.comparators[0])}"
+            text = f"( ( {cond} ) ? {self.expr(node.body)} : {self.expr(node.orelse)} )"
+        else:
+            error(f"unsupported expression {ast.unparse(node)}")
+        if self.count.get(key, 0) > 1:
+            name = f"_t{len(self.temp)}"
+            self.temp[key] = name
+            self.lines.append(f"  const double {name} = {text};")
+            return name
+        return text
+
+
+def load(filename):
+    with open(filename) as f:
+        desc = json.load(f)
+    celsius = ast.Constant(float(desc["temperature"]))
+    channels = []
+    for ch in desc["channels"]:
+        table = {"celsius": celsius}
+        for name, text in ch.get("const", {}).items():
+            node = parse(text, table)
+            if value(node) is None:
+                error(f"{ch['name']}: constant {name} is not constant")
+            table[name] = node
+        gates = []
+        for g in ch["gates"]:
+            local = dict(table)
+            for name, text in g.get("let", {}).items():
+                local[name] = parse(text, local)
+            gate = {"name": g["name"], "state": g.get("state"), "inf": parse(g["inf"], local)}
+            check(gate["inf"], g["name"])
+            if not g.get("instantaneous", False):
+                if gate["state"] is None or "tau" not in g:
+                    error(f"{g['name']}: a gate needs a state and tau unless it is instantaneous")
+                gate["tau"] = parse(g["tau"], local)
+                check(gate["tau"], g["name"])
+            gates.append(gate)
+        channels.append({"name": ch["name"], "gbar": ch["gbar"], "gates": gates})
+    return desc, channels
+
+
+def emit_rate(out, ch):
+    gates = [g for g in ch["gates"] if "tau" in g]
+    roots = [g["inf"] for g in gates] + [g["tau"] for g in gates]
+    e = Emitter(roots)
+    inf = [e.expr(g["inf"]) for g in gates]
+    tau = [e.expr(g["tau"]) for g in gates]
+    name = ch["name"]
+    out.append(f"static inline void rate_{name}_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )")
+    out.append("{")
+    out.extend(e.lines)
+    for j, g in enumerate(gates):
+        out.append(f"  inf [ {j} ] = {inf[j]}; // {g['name']}")
+        out.append(f"  tau [ {j} ] = {tau[j]};")
+    out.append("}")
+    out.append("")
+
+
+def emit_single(out, gate, kind):
+    node = gate[kind]
+    e = Emitter([node])
+    text = e.expr(node)
+    args = "const double v, const double ca" if uses_ca([node]) else "const double v"
+    out.append(f"static inline double {kind}_{gate['name']} ( {args} )")
+    out.append("{")
+    out.extend(e.lines)
+    out.append(f"  return {text};")
+    out.append("}")
+    out.append("")
+
+
+def generate(desc, channels, source):
+    lut = desc["lut"]
+    out = [
+        "// SPDX-License-Identifier: GPL-2.0-only",
+        "// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>",
+        "",
+        f"// Generated by helper/gen_channels.py from {source} (make channels); do not edit.",
+        "",
+        "#pragma once",
+        "",
+        "#include <math.h>",
+        '#include "ion.h"',
+        '#include "precision.h"',
+        '#include "config.h"',
+        "",
+        "#ifdef _OPENMP",
+        '#define OMP_SIMD _Pragma ( "omp simd" )',
+        "#else",
+        "#define OMP_SIMD // without OpenMP the loops are left to the auto-vectorizer",
+        "#endif",
+        "",
+        "//",
+        "// Lookup tables (ION_LUT == 1): ION_LUT_N rows of inf and tau of all gates of a channel, evenly spaced",
+        "// over the range, interpolated linearly and clamped to the range. Channels that depend on ca are always computed.",
+        "//",
+        f"#define ION_LUT_V_MIN ( {lut['v_min']!r} ) // [mV]",
+        f"#define ION_LUT_V_MAX ( {lut['v_max']!r} ) // [mV]",
+        "#define ION_LUT_DV ( ( ION_LUT_V_MAX - ION_LUT_V_MIN ) / ( ION_LUT_N - 1 ) ) // [mV]",
+        "",
+        "static inline void lut_interpolate ( const double *lut, const int n_gate, const double v, double * __restrict__ inf, double * __restrict__ tau )",
+        "{",
+        "  double x = ( v - ION_LUT_V_MIN ) / ION_LUT_DV;",
+        "  x = ( x < 0.0 ) ? 0.0 : ( x > ION_LUT_N - 1 ) ? ION_LUT_N - 1 : x;",
+        "  const int k = ( x < ION_LUT_N - 1 ) ? ( int ) x : ION_LUT_N - 2;",
+        "  const double f = x - k;",
+        "  const double *r0 = &lut [ 2 * n_gate * k ], *r1 = r0 + 2 * n_gate;",
+        "  for ( int j = 0; j < n_gate; j++ ) {",
+        "    inf [ j ] = r0 [ j ] + f * ( r1 [ j ] - r0 [ j ] );",
+        "    tau [ j ] = r0 [ n_gate + j ] + f * ( r1 [ n_gate + j ] - r0 [ n_gate + j ] );",
+        "  }",
+        "}",
+        "",
+    ]
+    for ch in channels:
+        name = ch["name"]
+        gates = [g for g in ch["gates"] if "tau" in g]
+        tabulated = not uses_ca([g[k] for g in gates for k in ("inf", "tau")])
+        out.append("//")
+        out.append(f"// {name}: {', '.join(g['name'] for g in ch['gates'])}")
+        out.append("//")
+        out.append(f"#define N_GATE_{name} ( {len(gates)} )")
+        if tabulated:
+            out.append("#if ION_LUT == 1")
+            out.append(f"static double lut_{name} [ ION_LUT_N * 2 * N_GATE_{name} ];")
+            out.append("#endif")
+        out.append("")
+        emit_rate(out, ch)
+        out.append(f"static inline __attribute__ ( ( always_inline ) ) void rate_{name} ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )")
+        out.append("{")
+        if tabulated:
+            out.append("#if ION_LUT == 1")
+            out.append(f"  lut_interpolate ( lut_{name}, N_GATE_{name}, v, inf, tau );")
+            out.append("#else")
+            out.append(f"  rate_{name}_exact ( v, ca, inf, tau );")
+            out.append("#endif")
+        else:
+            out.append(f"  rate_{name}_exact ( v, ca, inf, tau );")
+        out.append("}")
+        out.append("")
+        out.append(f"static inline void rate_{name}_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )")
+        out.append("{")
+        out.append("OMP_SIMD")
+        out.append("  for ( int k = 0; k < n; k++ ) {")
+        out.append(f"    double _inf [ N_GATE_{name} ], _tau [ N_GATE_{name} ];")
+        out.append(f"    rate_{name} ( v [ k ], ca [ k ], _inf, _tau );")
+        out.append(f"    for ( int j = 0; j < N_GATE_{name}; j++ ) {{ inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }}")
+        out.append("  }")
+        out.append("}")
+        out.append("")
+        for g in ch["gates"]:
+            emit_single(out, g, "inf")
+            if "tau" in g:
+                emit_single(out, g, "tau")
+
+    out.append("//")
+    out.append("// All channels")
+    out.append("//")
+    out.append("static inline void ion_lut_initialize ( void )")
+    out.append("{")
+    out.append("#if ION_LUT == 1")
+    out.append("  for ( int k = 0; k < ION_LUT_N; k++ ) {")
+    out.append("    const double v = ION_LUT_V_MIN + ION_LUT_DV * k;")
+    for ch in channels:
+        gates = [g for g in ch["gates"] if "tau" in g]
+        if not uses_ca([g[k] for g in gates for k in ("inf", "tau")]):
+            name = ch["name"]
+            out.append(f"    {{ double *r = &lut_{name} [ 2 * N_GATE_{name} * k ]; rate_{name}_exact ( v, 0.0, r, r + N_GATE_{name} ); }}")
+    out.append("  }")
+    out.append("#endif")
+    out.append("}")
+    out.append("")
+    out.append("// Exponential Euler step of the gates of the channels in mask (bit CHANNEL ( gbar ))")
+    out.append("static inline __attribute__ ( ( always_inline ) ) void update_gates ( const unsigned mask, const double v, const double ca, state_t * __restrict__ ion, const double dt )")
+    out.append("{")
+    for ch in channels:
+        gates = [g for g in ch["gates"] if "tau" in g]
+        name = ch["name"]
+        out.append(f"  if ( mask & CHANNEL ( {ch['gbar']} ) ) {{")
+        out.append(f"    double inf [ N_GATE_{name} ], tau [ N_GATE_{name} ];")
+        out.append(f"    rate_{name} ( v, ca, inf, tau );")
+        for j, g in enumerate(gates):
+            s = g["state"]
+            out.append(f"    ion [ {s} ] = inf [ {j} ] + ( ion [ {s} ] - inf [ {j} ] ) * exp ( - dt / tau [ {j} ] );")
+        out.append("  }")
+    out.append("}")
+    out.append("")
+    out.append("// Exponential Euler step of the gates of the channels in mask, in the compartments comp [ ptr [ g ] .. ptr [ g + 1 ] - 1 ]")
+    out.append("// of each channel g; gate s of compartment j is ion [ s * stride + j ]")
+    out.append("static inline __attribute__ ( ( always_inline ) ) void update_gates_comp ( const unsigned mask, const int * __restrict__ ptr, const int * __restrict__ comp,")
+    out.append("                                                                         const matrix_t * __restrict__ v, const double * __restrict__ ca, state_t * __restrict__ ion, const int stride, const double dt )")
+    out.append("{")
+    for ch in channels:
+        gates = [g for g in ch["gates"] if "tau" in g]
+        name = ch["name"]
+        out.append(f"  if ( mask & CHANNEL ( {ch['gbar']} ) ) {{")
+        out.append("OMP_SIMD")
+        out.append(f"    for ( int k = ptr [ {ch['gbar']} ]; k < ptr [ {ch['gbar']} + 1 ]; k++ ) {{")
+        out.append("      const int j = comp [ k ];")
+        out.append(f"      double inf [ N_GATE_{name} ], tau [ N_GATE_{name} ];")
+        out.append(f"      rate_{name} ( v [ j ], ca [ j ], inf, tau );")
+        for j, g in enumerate(gates):
+            s = g["state"]
+            out.append(f"      ion [ {s} * stride + j ] = inf [ {j} ] + ( ion [ {s} * stride + j ] - inf [ {j} ] ) * exp ( - dt / tau [ {j} ] );")
+        out.append("    }")
+        out.append("  }")
+    out.append("}")
+    out.append("")
+    out.append("// Steady state of the gates of all channels; gate s is ion [ s * stride ]")
+    out.append("static inline void init_gates ( const double v, const double ca, state_t * __restrict__ ion, const int stride )")
+    out.append("{")
+    for ch in channels:
+        gates = [g for g in ch["gates"] if "tau" in g]
+        name = ch["name"]
+        out.append(f"  {{ double inf [ N_GATE_{name} ], tau [ N_GATE_{name} ]; rate_{name}_exact ( v, ca, inf, tau );")
+        out.append("    " + " ".join(f"ion [ {g['state']} * stride ] = inf [ {j} ];" for j, g in enumerate(gates)) + " }")
+    out.append("}")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(f"usage: {sys.argv[0]} channels.json > ion_gen.h")
+    desc, channels = load(sys.argv[1])
+    sys.stdout.write(generate(desc, channels, sys.argv[1].split("/")[-1]))
+
+
+if __name__ == "__main__":
+    main()
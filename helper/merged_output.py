@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""
+Converter for the merged output of the MPI flavor (MERGED_OUTPUT == 1)
+
+Writes v.dat and s.dat in the same text format as the default kernel.
+
+Binary layout (native endian):
+  header: char magic[8] ("NLVOLT01" or "NLSPIK01"), int32 n_neurons, int32 inv_dt, float64 dt
+  v.bin : float64 v[n_steps][n_neurons], time of step k == k * dt
+  s.bin : int32 (t_ms, neuron id) pairs, grouped by output batch and rank
+
+Usage:
+    python merged_output.py [v.bin s.bin [v.dat s.dat]]
+"""
+import sys
+import struct
+from array import array
+
+HEADER = struct.Struct('=8siid')
+
+
+def read_header(f, magic):
+    m, n_neurons, inv_dt, dt = HEADER.unpack(f.read(HEADER.size))
+    if m != magic:
+        print(f"Error: {f.name} is not a {magic.decode()} file")
+        sys.exit(1)
+    return n_neurons, inv_dt, dt
+
+
+def main():
+    v_bin, s_bin, v_dat, s_dat = (sys.argv[1:] + ['v.bin', 's.bin', 'v.dat', 's.dat'][len(sys.argv) - 1:])[:4]
+
+    with open(v_bin, 'rb') as f, open(v_dat, 'w') as out:
+        n_neurons, inv_dt, dt = read_header(f, b'NLVOLT01')
+        step = 0
+        while True:
+            row = array('d')
+            try:
+                row.fromfile(f, n_neurons)
+            except EOFError:
+                break
+            out.write("%f " % (step * dt) + " ".join("%f" % v for v in row) + "\n")
+            step += 1
+
+    with open(s_bin, 'rb') as f, open(s_dat, 'w') as out:
+        read_header(f, b'NLSPIK01')
+        pairs = array('i')
+        pairs.frombytes(f.read())
+        spikes = sorted(zip(pairs[0::2], pairs[1::2]))
+        for t_ms, gid in spikes:
+            out.write(f"{t_ms} {gid}\n")
+
+
+if __name__ == "__main__":
+    main()
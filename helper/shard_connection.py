@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""
+Connection Sharder for the MPI flavor
+
+Splits a connection CSV into one binary file per MPI rank, so that each rank
+of flavors/mpi reads only its own connections at startup.
+Neurons are partitioned in the same way as flavors/mpi:
+  n_each = ceil(n_neurons / mpi_size), rank r owns [r * n_each, (r + 1) * n_each).
+
+Binary layout (little endian):
+  header: char magic[8] = "NLCONN01", int32 mpi_size, int32 rank, int64 n_records
+  record: int32 pre, post_i, post_c, delay; float64 weight, decay, rise, erev
+
+Usage:
+    python shard_connection.py population.csv connection.csv mpi_size prefix
+    mpirun -np mpi_size ./nl population.csv prefix.%d.bin
+"""
+import sys
+import struct
+
+HEADER = struct.Struct('<8siiq')
+RECORD = struct.Struct('<iiiidddd')
+
+
+def csv_lines(path):
+    with open(path) as f:
+        for line in f:
+            line = line.split('#', 1)[0].replace(' ', '').replace('\t', '').strip()
+            if line:
+                yield line
+
+
+def main():
+    if len(sys.argv) != 5:
+        print(f"Usage: {sys.argv[0]} population.csv connection.csv mpi_size prefix")
+        sys.exit(1)
+
+    pop_path, conn_path, mpi_size, prefix = sys.argv[1], sys.argv[2], int(sys.argv[3]), sys.argv[4]
+
+    n_neurons = sum(int(line.split(',')[0]) for line in csv_lines(pop_path))
+    n_each = (n_neurons + mpi_size - 1) // mpi_size
+
+    shards = [[] for _ in range(mpi_size)]
+    for line in csv_lines(conn_path):
+        f = line.split(',')
+        pre, post_i, post_c = int(f[0]), int(f[1]), int(f[2])
+        weight, decay, rise, erev = float(f[3]), float(f[4]), float(f[5]), float(f[6])
+        delay = int(f[7])
+        shards[post_i // n_each].append(RECORD.pack(pre, post_i, post_c, delay, weight, decay, rise, erev))
+
+    for rank, records in enumerate(shards):
+        with open(f"{prefix}.{rank}.bin", 'wb') as f:
+            f.write(HEADER.pack(b'NLCONN01', mpi_size, rank, len(records)))
+            f.write(b''.join(records))
+        print(f"{prefix}.{rank}.bin: {len(records)} connections")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+//
+// Microbenchmarks of the inner kernels (make bench).
+// ion.c and solver.c are included, so that their static functions are timed exactly as they are compiled for nl.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h> // getopt
+#include "ion.c"
+#include "solver.c"
+#include "timer.h"
+#include "config.h"
+
+#define N_V ( 1024 ) // # membrane potentials swept by the rate functions
+#define V_MIN ( -100.0 )
+#define V_MAX ( 50.0 )
+
+static int n_warmup = 3, n_repeat = 20;
+static const char *filter = NULL;
+static volatile double sink;
+
+static int compare_double ( const void *a, const void *b )
+{
+  const double x = *( const double * ) a, y = *( const double * ) b;
+  return ( x > y ) - ( x < y );
+}
+
+//
+// Calls prepare (untimed) and run n_warmup + n_repeat times, and reports the statistics of the timed repeats:
+// minimum, median, mean and standard deviation [us], and the median per item [ns].
+//
+static void bench ( const char *name, void ( *prepare ) ( void * ), void ( *run ) ( void * ), void *arg, const long n_item )
+{
+  if ( filter != NULL && strstr ( name, filter ) == NULL ) { return; }
+
+  for ( int r = 0; r < n_warmup; r++ ) { if ( prepare ) { prepare ( arg ); } run ( arg ); }
+  double *t = calloc ( n_repeat, sizeof ( double ) );
+  for ( int r = 0; r < n_repeat; r++ ) {
+    if ( prepare ) { prepare ( arg ); }
+    const double t0 = timer_now ( );
+    run ( arg );
+    t [ r ] = timer_now ( ) - t0;
+  }
+  qsort ( t, n_repeat, sizeof ( double ), compare_double );
+  double mean = 0.0, var = 0.0;
+  for ( int r = 0; r < n_repeat; r++ ) { mean += t [ r ] / n_repeat; }
+  for ( int r = 0; r < n_repeat; r++ ) { var += ( t [ r ] - mean ) * ( t [ r ] - mean ) / ( ( n_repeat > 1 ) ? n_repeat - 1 : 1 ); }
+  const double median = ( n_repeat % 2 ) ? t [ n_repeat / 2 ] : 0.5 * ( t [ n_repeat / 2 - 1 ] + t [ n_repeat / 2 ] );
+  printf ( "%-36s %12.3f %12.3f %12.3f %10.3f %12.3f\n", name, t [ 0 ] * 1e6, median * 1e6, mean * 1e6, sqrt ( var ) * 1e6, median / n_item * 1e9 );
+  free ( t );
+}
+
+//
+// Rate functions of ion_gen.h: single values, and all gates of a channel at once (rate_*_batch)
+//
+static double v_sweep [ N_V ];
+static double inf_z_SK_ca ( const double v ) { return inf_z_SK ( v, 1.0e-3 ); }
+
+typedef struct { const char *name; double ( *f ) ( const double ); } rate_t;
+#define RATE(f) { #f, f }
+static const rate_t rate [ ] = {
+  RATE ( inf_m_NaTs ), RATE ( inf_h_NaTs ), RATE ( tau_m_NaTs ), RATE ( tau_h_NaTs ),
+  RATE ( inf_m_NaTa ), RATE ( inf_h_NaTa ), RATE ( tau_m_NaTa ), RATE ( tau_h_NaTa ),
+  RATE ( inf_m_Nap ), RATE ( inf_h_Nap ), RATE ( tau_h_Nap ),
+  RATE ( inf_m_Kv2 ), RATE ( inf_h1_Kv2 ), RATE ( tau_m_Kv2 ), RATE ( tau_h1_Kv2 ), RATE ( tau_h2_Kv2 ),
+  RATE ( inf_m_Kv3 ), RATE ( tau_m_Kv3 ),
+  RATE ( inf_m_KP ), RATE ( inf_h_KP ), RATE ( tau_m_KP ), RATE ( tau_h_KP ),
+  RATE ( inf_m_KT ), RATE ( inf_h_KT ), RATE ( tau_m_KT ), RATE ( tau_h_KT ),
+  RATE ( inf_m_Kd ), RATE ( inf_h_Kd ), RATE ( tau_m_Kd ), RATE ( tau_h_Kd ),
+  RATE ( inf_m_Im ), RATE ( tau_m_Im ), RATE ( inf_m_Imv2 ), RATE ( tau_m_Imv2 ),
+  RATE ( inf_m_Ih ), RATE ( tau_m_Ih ),
+  { "inf_z_SK", inf_z_SK_ca }, RATE ( tau_z_SK ),
+  RATE ( inf_m_CaHVA ), RATE ( inf_h_CaHVA ), RATE ( tau_m_CaHVA ), RATE ( tau_h_CaHVA ),
+  RATE ( inf_m_CaLVA ), RATE ( inf_h_CaLVA ), RATE ( tau_m_CaLVA ), RATE ( tau_h_CaLVA ),
+};
+
+static void run_rate ( void *arg )
+{
+  const rate_t *r = arg;
+  double sum = 0.0;
+  for ( int k = 0; k < N_V; k++ ) { sum += r -> f ( v_sweep [ k ] ); }
+  sink = sum;
+}
+
+static double ca_sweep [ N_V ], inf_batch [ 4 * N_V ], tau_batch [ 4 * N_V ];
+typedef struct { const char *name; void ( *f ) ( const int, const double *, const double *, double *, double * ); } batch_t;
+#define BATCH(c) { "rate_" #c "_batch", rate_ ## c ## _batch }
+static const batch_t batch [ ] = {
+  BATCH ( NaTs ), BATCH ( NaTa ), BATCH ( Nap ), BATCH ( Kv2 ), BATCH ( Kv3 ), BATCH ( KP ), BATCH ( KT ),
+  BATCH ( Kd ), BATCH ( Im ), BATCH ( Imv2 ), BATCH ( Ih ), BATCH ( SK ), BATCH ( CaHVA ), BATCH ( CaLVA ),
+};
+
+static void run_batch ( void *arg )
+{
+  const batch_t *b = arg;
+  b -> f ( N_V, v_sweep, ca_sweep, inf_batch, tau_batch );
+  sink = inf_batch [ 0 ] + tau_batch [ 0 ];
+}
+
+//
+// Nav_update on N_V independent states
+//
+typedef struct { double init [ N_STATE_NAV ], *state; } nav_bench_t;
+
+static void prepare_nav ( void *arg )
+{
+  nav_bench_t *b = arg;
+  for ( int k = 0; k < N_V; k++ ) { memcpy ( &b -> state [ N_STATE_NAV * k ], b -> init, sizeof ( b -> init ) ); }
+}
+
+static void run_nav ( void *arg )
+{
+  nav_bench_t *b = arg;
+  for ( int k = 0; k < N_V; k++ ) {
+    double *s = &b -> state [ N_STATE_NAV * k ];
+    Nav_update ( v_sweep [ k ], DT, &s [ 0 ], &s [ 1 ], &s [ 2 ], &s [ 3 ], &s [ 4 ], &s [ 5 ], &s [ 6 ], &s [ 7 ], &s [ 8 ], &s [ 9 ], &s [ 10 ], &s [ 11 ] );
+  }
+}
+
+//
+// update_matrix, solve_matrix and update_ion on all neurons of a population
+//
+typedef struct { const population_t *u; const neuron_t *n; ion_t *i; const conn_t *c; synapse_t *s; solver_t *solver; int begin, end; } matrix_bench_t;
+
+static void run_update_matrix ( void *arg )
+{
+  matrix_bench_t *b = arg;
+  for ( int id = b -> begin; id < b -> end; id++ ) { update_matrix ( id, b -> u, b -> n, b -> i, b -> c, b -> s, b -> solver, 0.5*DT ); }
+}
+
+static void run_solve_matrix ( void *arg )
+{
+  matrix_bench_t *b = arg;
+  for ( int id = b -> begin; id < b -> end; id++ ) {
+    solve_linsys ( &b -> solver -> linsys [ id ] );
+  }
+}
+
+static void run_solve_matrix_loop ( void *arg ) // solve_matrix also where hines_gen.h has a solver
+{
+  matrix_bench_t *b = arg;
+  for ( int id = b -> begin; id < b -> end; id++ ) {
+    linsys_t *linsys = &b -> solver -> linsys [ id ];
+    if ( linsys -> H -> n_part > 0 ) { solve_matrix_multisplit ( linsys ); } else { solve_matrix ( linsys ); }
+  }
+}
+
+static void prepare_update_ion ( void *arg ) { run_update_matrix ( arg ); run_solve_matrix ( arg ); }
+
+static void run_update_ion ( void *arg )
+{
+  matrix_bench_t *b = arg;
+  for ( int id = b -> begin; id < b -> end; id++ ) { update_ion ( id, b -> u, b -> n, b -> solver -> linsys [ id ].b, b -> i, DT ); }
+}
+
+//
+// add_spike_to_synapse_per_ms on a synthetic connection table; every 8th connection has a spike in flight
+//
+typedef struct { conn_t c; synapse_t s; } spike_bench_t;
+
+static void prepare_spike ( void *arg )
+{
+  spike_bench_t *b = arg;
+  for ( long k = 0; k < b -> c.n_conn; k++ ) { b -> s.delay [ k ] = ( k % 8 == 0 ) ? ( 1 << ( 1 + k % 5 ) ) : 0; }
+}
+
+static void run_spike ( void *arg ) { spike_bench_t *b = arg; add_spike_to_synapse_per_ms ( &b -> c, &b -> s ); }
+
+int main ( int argc, char *argv [ ] )
+{
+  int opt;
+  while ( ( opt = getopt ( argc, argv, "w:r:" ) ) != -1 ) {
+    if      ( opt == 'w' ) { n_warmup = atoi ( optarg ); }
+    else if ( opt == 'r' ) { n_repeat = atoi ( optarg ); }
+    else { optind = argc + 1; break; }
+  }
+  if ( argc - optind < 2 || n_warmup < 0 || n_repeat < 1 ) {
+    fprintf ( stderr, "usage: %s [-w warmup] [-r repeat] <population_csv> <connection_csv> [filter]\n", argv [ 0 ] );
+    exit ( 1 );
+  }
+  filter = ( argc - optind > 2 ) ? argv [ optind + 2 ] : NULL;
+
+  population_t *u = initialize_population ( argv [ optind ] );
+  neuron_t *n     = initialize_neuron     ( u );
+  ion_t *i        = initialize_ion        ( u, n );
+  int *new_id;
+  conn_t *c       = initialize_connection ( u, n, argv [ optind + 1 ], &new_id );
+  synapse_t *s    = initialize_synapse    ( c );
+  solver_t *solver = initialize_solver    ( u );
+
+  printf ( "# %d warmup(s), %d repeat(s); DT = %g\n", n_warmup, n_repeat, DT );
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) { printf ( "# pid%d: channel mask 0x%04x\n", pid, u -> channel [ pid ] ); }
+  printf ( "%-36s %12s %12s %12s %10s %12s\n", "# kernel", "min [us]", "median [us]", "mean [us]", "sd [us]", "[ns]/item" );
+
+  for ( int k = 0; k < N_V; k++ ) { v_sweep [ k ] = V_MIN + ( V_MAX - V_MIN ) * k / ( N_V - 1 ); ca_sweep [ k ] = 1.0e-3; }
+  ion_lut_initialize ( );
+  for ( int k = 0; k < ( int ) ( sizeof ( rate ) / sizeof ( rate [ 0 ] ) ); k++ ) {
+    bench ( rate [ k ].name, NULL, run_rate, ( void * ) &rate [ k ], N_V );
+  }
+  for ( int k = 0; k < ( int ) ( sizeof ( batch ) / sizeof ( batch [ 0 ] ) ); k++ ) {
+    bench ( batch [ k ].name, NULL, run_batch, ( void * ) &batch [ k ], N_V );
+  }
+
+  if ( n -> n_neuron > 0 ) {
+    nav_bench_t b = { .state = calloc ( N_STATE_NAV * N_V, sizeof ( double ) ) };
+    for ( int k = 0; k < N_STATE_NAV; k++ ) { b.init [ k ] = i -> gate [ ( OO_NaV + k ) * GATE_STRIDE ( u, 0 ) ]; }
+    bench ( "Nav_update", prepare_nav, run_nav, &b, N_V );
+    free ( b.state );
+  }
+
+  for ( int pid = 0, begin = 0; pid < u -> n_popl; begin += u -> n_neuron [ pid ], pid++ ) {
+    if ( u -> n_neuron [ pid ] == 0 ) { continue; }
+    matrix_bench_t b = { u, n, i, c, s, solver, begin, begin + u -> n_neuron [ pid ] };
+    char name [ 64 ];
+    snprintf ( name, sizeof ( name ), "update_matrix/pid%d (%d comp)", pid, u -> n_comp [ pid ] );
+    bench ( name, NULL, run_update_matrix, &b, u -> n_neuron [ pid ] );
+    snprintf ( name, sizeof ( name ), "solve_matrix/pid%d (%d comp)", pid, u -> n_comp [ pid ] );
+    bench ( name, run_update_matrix, run_solve_matrix, &b, u -> n_neuron [ pid ] );
+    if ( solver -> linsys [ begin ].H -> solve != NULL ) {
+      snprintf ( name, sizeof ( name ), "solve_matrix_loop/pid%d (%d comp)", pid, u -> n_comp [ pid ] );
+      bench ( name, run_update_matrix, run_solve_matrix_loop, &b, u -> n_neuron [ pid ] );
+    }
+    snprintf ( name, sizeof ( name ), "update_ion/pid%d (0x%04x)", pid, u -> channel [ pid ] );
+    bench ( name, prepare_update_ion, run_update_ion, &b, u -> n_neuron [ pid ] );
+  }
+
+  for ( int n_conn = 1000; n_conn <= 10000000; n_conn *= 10 ) {
+    spike_bench_t b = { .c = { .n_conn = n_conn, .n_double = n_conn }, .s = { .sum0 = calloc ( n_conn, sizeof ( state_t ) ), .sum1 = calloc ( n_conn, sizeof ( state_t ) ), .delay = calloc ( n_conn, sizeof ( int ) ) } };
+    char name [ 64 ];
+    snprintf ( name, sizeof ( name ), "add_spike_to_synapse_per_ms/%d", n_conn );
+    bench ( name, prepare_spike, run_spike, &b, n_conn );
+    free ( b.s.delay );
+    free ( b.s.sum1 );
+    free ( b.s.sum0 );
+  }
+
+  finalize_solver       ( solver );
+  finalize_synapse      ( s );
+  finalize_connection   ( c );
+  free ( new_id );
+  finalize_ion          ( i );
+  finalize_neuron       ( n );
+  finalize_population   ( u );
+  return 0;
+}
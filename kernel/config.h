@@ -13,6 +13,34 @@
 #define SPIKE_THRESHOLD ( -15.0 )
 #define ALLACTIVE ( 0 ) // Set to 1 for allactive models
 
+// Network parameters
+#define REORDER ( 0 ) // Set to 1 to renumber neurons within each population by connectivity (reverse Cuthill-McKee)
+
+// Solver parameters
+#define MULTISPLIT ( 0 ) // Set to N > 1 to solve the matrix of each large neuron as N parts in parallel (OpenMP)
+#define MULTISPLIT_MIN_COMP ( 1000 ) // Neurons with fewer compartments are not split
+#define RENUMBER ( 1 ) // Renumber the compartments of each morphology into long unbranched runs for the Hines solver
+#define DLAMBDA ( 0.0 ) // Set to d > 0 to re-discretize each morphology at load time so that a compartment is at most d of the AC length constant (d_lambda rule; 0.1 is too coarse for the spike timing, see test/equivalence)
+#define DLAMBDA_FREQ ( 100.0 ) // [Hz] frequency of the AC length constant of DLAMBDA
+#define HINES_GEN ( 1 ) // Solve the morphologies covered by hines_gen.h (make hines) with their straight-line solvers
+#define MIXED_PRECISION ( 0 ) // Set to 1 to store gates and synapses in float, 2 to solve the matrix in float as well (see precision.h)
+#define QUIESCENT ( 0 ) // Set to 1 to skip neurons at rest until a synaptic input arrives or their current changes
+#define QUIESCENT_DV ( 1e-6 ) // [mV] largest change of v over 1 ms of a neuron at rest
+#define QUIESCENT_DCA ( 1e-9 ) // [mM] largest change of ca over 1 ms of a neuron at rest
+#define QUIESCENT_DGATE ( 1e-6 ) // largest change of a gate over 1 ms of a neuron at rest
+#define QUIESCENT_SUM0 ( 1e-6 ) // largest synaptic trace (sum0) of a neuron at rest
+#define ADAPTIVE ( 0 ) // Set to 1 to choose the # of substeps of each neuron for each ms by error control (the population CSV is ignored)
+#define ADAPTIVE_TOL ( 0.001 ) // [mV] largest local error of the somatic v per substep
+#define ADAPTIVE_MAX_LEVEL ( 5 ) // the finest level uses DT, and each level below halves the # of substeps
+#define CHANNEL_SPECIALIZE ( 1 ) // Set to 0 to evaluate all channels, also those with zero conductance
+#define CHANNEL_MASKS // list of CHANNEL_VARIANT ( mask ) compiled with a constant channel mask; nl_bench prints the mask of each population
+#define ION_LUT ( 0 ) // Set to 1 to interpolate the gate kinetics from tables instead of computing them (ion_gen.h)
+#define ION_LUT_N ( 5001 ) // # rows of the tables, evenly spaced over the range of channels.json
+
+// Diagnostics
+#define PROFILE ( 0 ) // Set to 1 to time each phase per population; the report goes to stderr and profile.json
+#define PROGRESS_INTERVAL ( 1.0 ) // [s] wall-clock time between progress lines
+
 // Current injection parameters
 #define I_AMP ( 0.12 )
 #define I_DELAY ( 500.0 )
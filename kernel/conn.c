@@ -6,24 +6,88 @@
 #include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <limits.h>
 #include "conn.h"
 #include "neuron.h"
+#include "reorder.h"
 #include "config.h"
 
 extern int strip_comment_destructive ( char * );
 extern int remove_blank_destructive_for_csv ( char * );
 extern int get_lines ( const char * );
 
-conn_t *initialize_connection ( const population_t *u, const neuron_t *n, const char *filename )
+//
+// Synapse types are interned through an open-addressing hash on ( erev, decay, rise ), so that a connection costs O(1)
+// at load time however many types there are. The table has twice N_SYN_TYPE_MAX slots (a power of 2), so it is at most
+// half full; a slot holds type + 1, and 0 is empty.
+//
+#define TYPE_HASH_SIZE ( 2 * N_SYN_TYPE_MAX )
+
+static unsigned long hash_type ( const state_t erev, const state_t decay, const state_t rise )
+{
+  const state_t key [ 3 ] = { erev + ( state_t ) 0, decay + ( state_t ) 0, rise + ( state_t ) 0 }; // -0 == 0
+  unsigned char bytes [ sizeof ( key ) ];
+  memcpy ( bytes, key, sizeof ( key ) );
+  unsigned long h = 14695981039346656037UL; // FNV-1a
+  for ( size_t k = 0; k < sizeof ( bytes ); k++ ) { h = ( h ^ bytes [ k ] ) * 1099511628211UL; }
+  return h;
+}
+
+// Index of the synapse type with the given kinetics; a new type is appended
+static int intern_type ( conn_t *c, int *slot, const state_t erev, const state_t decay, const state_t rise, int *capacity )
+{
+  unsigned long h = hash_type ( erev, decay, rise ) & ( TYPE_HASH_SIZE - 1 );
+  for ( ; slot [ h ] != 0; h = ( h + 1 ) & ( TYPE_HASH_SIZE - 1 ) ) {
+    const int t = slot [ h ] - 1;
+    if ( c -> erev [ t ] == erev && c -> decay [ t ] == decay && c -> rise [ t ] == rise ) { return t; }
+  }
+  if ( c -> n_type == N_SYN_TYPE_MAX ) { fprintf ( stderr, "Error: more than %d synapse types\n", N_SYN_TYPE_MAX ); exit ( 1 ); }
+  if ( c -> n_type == *capacity ) {
+    *capacity *= 2;
+    c -> erev  = realloc ( c -> erev,  *capacity * sizeof ( state_t ) );
+    c -> decay = realloc ( c -> decay, *capacity * sizeof ( state_t ) );
+    c -> rise  = realloc ( c -> rise,  *capacity * sizeof ( state_t ) );
+  }
+  c -> erev  [ c -> n_type ] = erev;
+  c -> decay [ c -> n_type ] = decay;
+  c -> rise  [ c -> n_type ] = rise;
+  slot [ h ] = c -> n_type + 1;
+  return c -> n_type++;
+}
+
+//
+// A line of the connection file: pre, post_i, post_c, weight, tau_decay, tau_rise, erev, delay, e/i.
+// Lines without tau_rise (the format of flavors/sglexp) and lines with a tau_rise of 0 are single-exponential synapses.
+//
+static syn_kind_t read_connection_line ( const char *buf, int *pre, int *post_i, int *post_c, double *weight, double *decay, double *rise, double *erev, int *delay )
+{
+  char c_type;
+  if ( sscanf ( buf, "%d,%d,%d,%lf,%lf,%lf,%lf,%d,%c", pre, post_i, post_c, weight, decay, rise, erev, delay, &c_type ) == 9 ) {
+    return ( *rise == 0.0 ) ? SYN_SINGLE : SYN_DOUBLE;
+  }
+  const int nf = sscanf ( buf, "%d,%d,%d,%lf,%lf,%lf,%d,%c", pre, post_i, post_c, weight, decay, erev, delay, &c_type );
+  if ( nf != 8 ) { fprintf ( stderr, "Error: cannot read the connection %s\n", buf ); exit ( 1 ); }
+  *rise = 0.0;
+  return SYN_SINGLE;
+}
+
+conn_t *initialize_connection ( const population_t *u, const neuron_t *n, const char *filename, int **new_id_out )
 {
   conn_t *c = calloc (1, sizeof ( conn_t ) );
 
-  if ( n -> n_neuron == 0 ) { c -> n_conn = 0; return c; }
+  if ( n -> n_neuron == 0 ) { c -> n_conn = 0; *new_id_out = reorder_neurons ( n, 0, NULL ); return c; }
  
   int *pre_ary  = calloc ( n -> n_neuron, sizeof ( int ) );
-  int *post_ary = calloc ( n -> n_neuron, sizeof ( int ) );
-  int n_conn = 0, n_pre = 0;
+  int *post_ary = calloc ( n -> n_neuron * N_SYN_KIND, sizeof ( int ) ); // [ kind ][ neuron ]
+  long *pre_slot = calloc ( n -> n_neuron, sizeof ( long ) ); // first slot of each presynaptic neuron
+  long n_conn = 0;
+  int n_pre = 0;
+  int *new_id;
+  // The first pass counts the connections of each neuron by the ids in the file, and collects the ( pre, post ) pairs
+  // for the reordering, which gives the neuron ids of the second pass
   {
+    long capacity = ( REORDER == 1 ) ? 1024 : 0;
+    int *edge = ( REORDER == 1 ) ? malloc ( 2 * capacity * sizeof ( int ) ) : NULL;
     char buf [ 1024 ] ;
     FILE *file = fopen ( filename, "r" );
     if ( ! file ) { fprintf ( stderr, "Error: no such file %s\n", filename ); exit ( 1 ); }
@@ -31,14 +95,37 @@ conn_t *initialize_connection ( const population_t *u, const neuron_t *n, const
     while ( fgets ( buf, 1024, file ) ) {
       if ( strip_comment_destructive ( buf ) == 0 ) { continue; }
       if ( remove_blank_destructive_for_csv ( buf ) == 0 ) { continue; }
-      int d_pre, d_post_i;
-      const int nf = sscanf ( buf, "%d,%d", &d_pre, &d_post_i );
-      assert ( nf == 2 );
-      n_conn += 2;
-      pre_ary  [ d_pre    ] += 2;
-      post_ary [ d_post_i ] += 2;
+      int d_pre, d_post_i, d_post_c, d_delay;
+      double f_weight, f_decay, f_rise, f_erev;
+      const syn_kind_t kind = read_connection_line ( buf, &d_pre, &d_post_i, &d_post_c, &f_weight, &f_decay, &f_rise, &f_erev, &d_delay );
+      if ( d_pre < 0 || d_pre >= n -> n_neuron || d_post_i < 0 || d_post_i >= n -> n_neuron ) {
+	fprintf ( stderr, "Error: connection %ld from %d to %d is out of the %d neurons\n", n_conn, d_pre, d_post_i, n -> n_neuron ); exit ( 1 );
+      }
+      if ( pre_ary [ d_pre ] == INT_MAX || post_ary [ d_post_i + n -> n_neuron * kind ] == INT_MAX ) {
+	fprintf ( stderr, "Error: neuron %d or %d has more than %d connections\n", d_pre, d_post_i, INT_MAX ); exit ( 1 );
+      }
+      if ( REORDER == 1 ) {
+	if ( n_conn == capacity ) { capacity *= 2; edge = realloc ( edge, 2 * capacity * sizeof ( int ) ); }
+	edge [ 2 * n_conn + 0 ] = d_pre;
+	edge [ 2 * n_conn + 1 ] = d_post_i;
+      }
+      n_conn++;
+      pre_ary  [ d_pre ]++;
+      post_ary [ d_post_i + n -> n_neuron * kind ]++;
     }
     fclose ( file );
+
+    new_id = reorder_neurons ( n, ( REORDER == 1 ) ? n_conn : 0, edge );
+    free ( edge );
+    if ( REORDER == 1 ) {
+      int *count = malloc ( n -> n_neuron * sizeof ( int ) );
+      for ( int k = 0; k < N_SYN_KIND + 1; k++ ) { // the pre counts, then the post counts of each kind
+	int *ary = ( k == 0 ) ? pre_ary : &post_ary [ n -> n_neuron * ( k - 1 ) ];
+	for ( int i = 0; i < n -> n_neuron; i++ ) { count [ new_id [ i ] ] = ary [ i ]; }
+	for ( int i = 0; i < n -> n_neuron; i++ ) { ary [ i ] = count [ i ]; }
+      }
+      free ( count );
+    }
     for ( int i = 0; i < n -> n_neuron; i++ ) { if ( pre_ary [ i ] > 0 ) { n_pre++; } }
   }
 
@@ -54,7 +141,7 @@ conn_t *initialize_connection ( const population_t *u, const neuron_t *n, const
     }
     assert ( j == c -> n_pre );
   }
-  c -> ptr_pre = calloc ( c -> n_pre + 1, sizeof ( int ) );
+  c -> ptr_pre = calloc ( c -> n_pre + 1, sizeof ( long ) );
   {
     int j = 0;
     c -> ptr_pre [ 0 ] = 0;
@@ -63,66 +150,76 @@ conn_t *initialize_connection ( const population_t *u, const neuron_t *n, const
     }
     assert ( j == c -> n_pre );
   }
-  c -> ptr_post = calloc ( c -> n_post + 1, sizeof ( int ) );
+  c -> ptr_post = calloc ( c -> n_post * N_SYN_KIND + 1, sizeof ( long ) );
   {
     c -> ptr_post [ 0 ] = 0;
-    for ( int i = 0; i < c -> n_post; i++ ) {
+    for ( int i = 0; i < c -> n_post * N_SYN_KIND; i++ ) {
       c -> ptr_post [ i + 1 ] = c -> ptr_post [ i ] + post_ary [ i ];
     }
+    c -> n_double = c -> ptr_post [ c -> n_post * SYN_SINGLE ];
+  }
+  // pre_ary and post_ary are reused as the # connections placed of each neuron, so the file need not be sorted by pre
+  {
+    int j = 0;
+    for ( int i = 0; i < n -> n_neuron; i++ ) {
+      if ( pre_ary [ i ] > 0 ) { pre_slot [ i ] = c -> ptr_pre [ j ]; j++; }
+      pre_ary [ i ] = 0;
+    }
+    for ( int i = 0; i < n -> n_neuron * N_SYN_KIND; i++ ) { post_ary [ i ] = 0; }
   }
-  free (pre_ary);
-  free (post_ary);
  
   c -> post_c = calloc ( c -> n_conn, sizeof ( int ) );
-  c -> weight = calloc ( c -> n_conn, sizeof ( double ) );
-  c -> erev   = calloc ( c -> n_conn, sizeof ( double ) );
-  c -> decay  = calloc ( c -> n_conn, sizeof ( double ) );
+  c -> weight = calloc ( c -> n_conn, sizeof ( state_t ) );
+  c -> type   = calloc ( c -> n_conn, sizeof ( unsigned short ) );
+  int capacity = 16; // of the type table
+  c -> erev   = calloc ( capacity, sizeof ( state_t ) );
+  c -> decay  = calloc ( capacity, sizeof ( state_t ) );
+  c -> rise   = calloc ( capacity, sizeof ( state_t ) );
+  int *type_slot = calloc ( TYPE_HASH_SIZE, sizeof ( int ) ); // hash of the type table
   c -> delay = calloc ( c -> n_conn, sizeof ( int ) );
-  c -> id    = calloc ( c -> n_conn, sizeof ( int ) );
+  c -> id    = calloc ( c -> n_conn, sizeof ( long ) );
 
   { 
-    int *local_idx = calloc ( c -> n_post, sizeof ( int ) );
     FILE *file = fopen ( filename, "r" );
     char buf [ 1024 ];
-    int idx = 0;
     while ( fgets ( buf, 1024, file ) ) {
       if ( strip_comment_destructive ( buf ) == 0 ) { continue; }
       if ( remove_blank_destructive_for_csv ( buf ) == 0 ) { continue; }
       int d_pre, d_post_i, d_post_c, d_delay;
       double f_weight, f_decay, f_rise, f_erev;
-      char c_type;
-      const int nf = sscanf ( buf, "%d,%d,%d,%lf,%lf,%lf,%lf,%d,%c", &d_pre, &d_post_i, &d_post_c, &f_weight, &f_decay, &f_rise, &f_erev, &d_delay, &c_type );
-      assert ( nf == 9 );
+      const syn_kind_t kind = read_connection_line ( buf, &d_pre, &d_post_i, &d_post_c, &f_weight, &f_decay, &f_rise, &f_erev, &d_delay );
+      d_pre = new_id [ d_pre ]; d_post_i = new_id [ d_post_i ];
 
-      assert ( d_post_c < u -> n_comp [ n -> pid [ d_post_i ] ] );
-      assert ( d_delay > 0 );
+      assert ( d_post_c < u -> swc_cid [ n -> pid [ d_post_i ] + 1 ] - u -> swc_cid [ n -> pid [ d_post_i ] ] );
+      if ( d_delay <= 0 || d_delay >= DELAY_MAX ) { fprintf ( stderr, "Error: delay %d is not in 1 .. %d\n", d_delay, DELAY_MAX - 1 ); exit ( 1 ); }
+      d_post_c = u -> cmap [ u -> swc_cid [ n -> pid [ d_post_i ] ] + d_post_c ]; // SWC id -> compartment id
       
-      const double tau_prime = f_decay * f_rise / ( f_decay - f_rise );
-      const double tau_diff  = f_rise / f_decay;
-      const double norm_coef = 1.0 / ( pow ( tau_diff, ( tau_prime / f_decay ) ) - pow ( tau_diff, ( tau_prime / f_rise ) ) );
-      const int solver_id1 = c -> ptr_post [ d_post_i ] + local_idx [ d_post_i ];
-      c -> post_c [ solver_id1 ] = d_post_c;
-      c -> weight [ solver_id1 ] = norm_coef * f_weight;
-      c -> erev   [ solver_id1 ] = f_erev;
-      c -> decay  [ solver_id1 ] = exp ( - DT / f_decay );
-      local_idx [ d_post_i ]++;
-      c -> delay [ idx ] = d_delay;
-      c -> id    [ idx ] = solver_id1;
-      idx++;
-      const int solver_id2 = c -> ptr_post [ d_post_i ] + local_idx [ d_post_i ];
-      c -> post_c [ solver_id2 ] = d_post_c;
-      c -> weight [ solver_id2 ] = - norm_coef * f_weight;
-      c -> erev   [ solver_id2 ] = f_erev;
-      c -> decay  [ solver_id2 ] = exp ( - DT / f_rise );
-      local_idx [ d_post_i ]++;
-      c -> delay [ idx ] = d_delay;
-      c -> id    [ idx ] = solver_id2;
-      idx++;
+      double norm_coef = 1.0; // single exponential: the peak is the weight
+      if ( kind == SYN_DOUBLE ) {
+	const double tau_prime = f_decay * f_rise / ( f_decay - f_rise );
+	const double tau_diff  = f_rise / f_decay;
+	norm_coef = 1.0 / ( pow ( tau_diff, ( tau_prime / f_decay ) ) - pow ( tau_diff, ( tau_prime / f_rise ) ) );
+      }
+      const int k = d_post_i + c -> n_post * kind;
+      const long solver_id = c -> ptr_post [ k ] + post_ary [ k ];
+      c -> post_c [ solver_id ] = d_post_c;
+      c -> weight [ solver_id ] = norm_coef * f_weight; // the rise trace has - weight
+      c -> type   [ solver_id ] = intern_type ( c, type_slot, f_erev,
+					      exp ( - u -> dt [ n -> pid [ d_post_i ] ] / f_decay ), // on the grid of the postsynaptic population
+					      ( kind == SYN_DOUBLE ) ? exp ( - u -> dt [ n -> pid [ d_post_i ] ] / f_rise ) : 0.0, &capacity );
+      post_ary [ k ]++;
+      c -> delay [ pre_slot [ d_pre ] + pre_ary [ d_pre ] ] = d_delay;
+      c -> id    [ pre_slot [ d_pre ] + pre_ary [ d_pre ] ] = solver_id;
+      pre_ary [ d_pre ]++;
     }
-    free ( local_idx );
     fclose ( file );
   }
-  
+  free ( type_slot );
+  free ( pre_slot );
+  free ( post_ary );
+  free ( pre_ary );
+
+  *new_id_out = new_id;
   return c;
 }
 
@@ -133,8 +230,10 @@ void finalize_connection ( conn_t *c )
   if ( c -> ptr_post  != NULL ) { free ( c -> ptr_post  ); }
   if ( c -> post_c != NULL ) { free ( c -> post_c ); }
   if ( c -> weight != NULL ) { free ( c -> weight ); }
+  if ( c -> type   != NULL ) { free ( c -> type   ); }
   if ( c -> erev   != NULL ) { free ( c -> erev   ); }
   if ( c -> decay  != NULL ) { free ( c -> decay  ); }
+  if ( c -> rise   != NULL ) { free ( c -> rise   ); }
   if ( c -> delay != NULL ) { free ( c -> delay ); }
   if ( c -> id    != NULL ) { free ( c -> id    ); }
   free ( c );
@@ -5,15 +5,35 @@
 
 #include "popl.h"
 #include "neuron.h"
+#include "precision.h"
+
+//
+// One record per connection of the file: a double-exponential synapse is the difference of a decay and a rise trace
+// (sum0 and sum1 of synapse_t), which share post_c, weight, erev and delay; a single-exponential one has the decay trace only.
+// Connections are grouped by kind, and by postsynaptic neuron within a kind, so that the loop over each kind has no branch:
+// the connections of kind k onto the neuron i are ptr_post [ i + n_post * k ] .. ptr_post [ i + 1 + n_post * k ] - 1,
+// and the first n_double connections are the double-exponential ones.
+// The kinetics (erev and the factors of the traces per step) take few distinct values, one per edge type of the model,
+// so they are kept in a table of synapse types, and a connection stores only its type.
+//
+#define N_SYN_TYPE_MAX ( 65536 ) // the range of the type of a connection
+#define DELAY_MAX ( 31 ) // the delays in flight are the bits of an int (synapse_t)
+
+typedef enum { SYN_DOUBLE, SYN_SINGLE, N_SYN_KIND } syn_kind_t;
 
 typedef struct {
   int *post_c; // for solver
-  double *weight, *erev, *decay; // for solver
-  int *delay, *id; // for synapse
-  int n_pre, n_post, n_conn;
+  state_t *weight; // for solver
+  unsigned short *type; // for solver; index into erev, decay and rise
+  state_t *erev, *decay, *rise; // size == n_type
+  int n_type;
+  int *delay; // for synapse; [ms] < DELAY_MAX
+  long *id; // for synapse; connection id in the postsynaptic order of each connection in the presynaptic order
+  int n_pre, n_post;
+  long n_conn, n_double; // connections are counted in 64 bits; a neuron has fewer than 2^31 of them
   int *pre_table;
-  int *ptr_pre, *ptr_post; // cumulative connection id
+  long *ptr_pre, *ptr_post; // cumulative connection id; size == n_pre + 1, n_post * N_SYN_KIND + 1
 } conn_t;
 
-extern conn_t *initialize_connection ( const population_t *, const neuron_t *, const char * );
+extern conn_t *initialize_connection ( const population_t *, const neuron_t *, const char *, int ** ); // the last argument receives new_id, which maps ids in the file to neuron ids; see reorder_neurons
 extern void finalize_connection ( conn_t * );
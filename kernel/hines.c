@@ -3,24 +3,109 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include "popl.h"
 #include "hines.h"
+#include "hines_gen.h"
+#include "config.h"
 
 hines_matrix_t *hines_matrix_allocate ( int n )
 {
   hines_matrix_t *H = ( hines_matrix_t * ) malloc ( sizeof ( hines_matrix_t ) );
   
   H -> n_comp    = n;
-  H -> Ad        = calloc ( H -> n_comp, sizeof ( double ) );
-  H -> Api       = calloc ( H -> n_comp, sizeof ( double ) );
-  H -> bu_Ad     = calloc ( H -> n_comp, sizeof ( double ) );
-  H -> bu_Api    = calloc ( H -> n_comp, sizeof ( double ) );
+  H -> Ad        = calloc ( H -> n_comp, sizeof ( matrix_t ) );
+  H -> Api       = calloc ( H -> n_comp, sizeof ( matrix_t ) );
   H -> parent_id = calloc ( H -> n_comp, sizeof ( int ) );
+  H -> n_part    = 0;
+  H -> part_ptr  = NULL;
+  H -> part_node = NULL;
+  H -> n_root    = 0;
+  H -> root_node = NULL;
+  H -> solve     = NULL;
   
   return H;
 }
 
+//
+// Multisplit: grow a root region from the soma by repeatedly moving the top of the largest remaining subtree into it,
+// until every subtree has at most n_comp / n_part compartments. The subtrees are then packed into n_part parts
+// (largest first into the lightest part). Compartments are numbered parents first, so each part can be
+// eliminated independently, and the root region is done serially in the same order as the plain solver.
+//
+static void hines_matrix_split ( hines_matrix_t *H, const int n_part )
+{
+  const int n = H -> n_comp;
+  const int *parent = H -> parent_id;
+  for ( int i = 1; i < n; i++ ) { assert ( 0 <= parent [ i ] && parent [ i ] < i ); }
+
+  int *size = calloc ( n, sizeof ( int ) ); // # compartments of the subtree
+  for ( int i = n - 1; i >= 0; i-- ) { size [ i ]++; if ( i > 0 ) { size [ parent [ i ] ] += size [ i ]; } }
+  int *child_ptr = calloc ( n + 1, sizeof ( int ) );
+  for ( int i = 1; i < n; i++ ) { child_ptr [ parent [ i ] + 1 ]++; }
+  for ( int i = 0; i < n; i++ ) { child_ptr [ i + 1 ] += child_ptr [ i ]; }
+  int *child = calloc ( n, sizeof ( int ) );
+  {
+    int *pos = calloc ( n, sizeof ( int ) );
+    for ( int i = 1; i < n; i++ ) { child [ child_ptr [ parent [ i ] ] + pos [ parent [ i ] ]++ ] = i; }
+    free ( pos );
+  }
+
+  // Subtree tops; the root region is everything that is not below one of them
+  const int target = ( n + n_part - 1 ) / n_part;
+  int *top = calloc ( n, sizeof ( int ) ), n_top = 0;
+  for ( int j = child_ptr [ 0 ]; j < child_ptr [ 1 ]; j++ ) { top [ n_top++ ] = child [ j ]; }
+  while ( n_top > 0 ) {
+    int k_max = 0;
+    for ( int k = 1; k < n_top; k++ ) { if ( size [ top [ k ] ] > size [ top [ k_max ] ] ) { k_max = k; } }
+    if ( size [ top [ k_max ] ] <= target ) { break; }
+    const int t = top [ k_max ];
+    top [ k_max ] = top [ --n_top ];
+    for ( int j = child_ptr [ t ]; j < child_ptr [ t + 1 ]; j++ ) { top [ n_top++ ] = child [ j ]; }
+  }
+
+  // Pack the subtrees into parts
+  int *load = calloc ( n_part, sizeof ( int ) );
+  int *owner = calloc ( n, sizeof ( int ) ); // part of each compartment, -1 == root region
+  for ( int i = 0; i < n; i++ ) { owner [ i ] = -1; }
+  for ( int done = 0; done < n_top; done++ ) {
+    int k_max = done;
+    for ( int k = done + 1; k < n_top; k++ ) { if ( size [ top [ k ] ] > size [ top [ k_max ] ] ) { k_max = k; } }
+    const int t = top [ k_max ]; top [ k_max ] = top [ done ]; top [ done ] = t;
+    int p_min = 0;
+    for ( int p = 1; p < n_part; p++ ) { if ( load [ p ] < load [ p_min ] ) { p_min = p; } }
+    owner [ t ] = p_min;
+    load [ p_min ] += size [ t ];
+  }
+  for ( int i = 1; i < n; i++ ) { if ( owner [ i ] < 0 ) { owner [ i ] = owner [ parent [ i ] ]; } } // parents first
+
+  H -> n_part    = n_part;
+  H -> part_ptr  = calloc ( n_part + 1, sizeof ( int ) );
+  H -> part_node = calloc ( n, sizeof ( int ) );
+  H -> root_node = calloc ( n, sizeof ( int ) );
+  H -> n_root    = 0;
+  for ( int i = 1; i < n; i++ ) {
+    if ( owner [ parent [ i ] ] < 0 ) { H -> root_node [ H -> n_root++ ] = i; }
+    else                              { H -> part_ptr [ owner [ i ] + 1 ]++; }
+  }
+  for ( int p = 0; p < n_part; p++ ) { H -> part_ptr [ p + 1 ] += H -> part_ptr [ p ]; }
+  {
+    int *pos = calloc ( n_part, sizeof ( int ) );
+    for ( int i = 1; i < n; i++ ) {
+      if ( owner [ parent [ i ] ] >= 0 ) { H -> part_node [ H -> part_ptr [ owner [ i ] ] + pos [ owner [ i ] ]++ ] = i; }
+    }
+    free ( pos );
+  }
+
+  free ( owner );
+  free ( load );
+  free ( top );
+  free ( child );
+  free ( child_ptr );
+  free ( size );
+}
+
 hines_matrix_t *hines_matrix_initialize ( const population_t *u, const int pid )
 {
   hines_matrix_t *H = hines_matrix_allocate ( u -> n_comp [ pid ] );
@@ -28,10 +113,14 @@ hines_matrix_t *hines_matrix_initialize ( const population_t *u, const int pid )
   for ( int i = 0; i < H -> n_comp; i++ ) {
     H -> Ad        [ i ] = 0.0;
     H -> Api       [ i ] = 0.0;
-    H -> bu_Ad     [ i ] = 0.0;
-    H -> bu_Api    [ i ] = 0.0;
     H -> parent_id [ i ] = ( int ) u -> parent [ u -> cid [ pid ] + i ];
   }
+  if ( MULTISPLIT > 1 && H -> n_comp >= MULTISPLIT_MIN_COMP ) { hines_matrix_split ( H, MULTISPLIT ); }
+  if ( HINES_GEN == 1 && H -> n_part == 0 ) { // the whole tree has to match
+    for ( const hines_gen_t *g = hines_gen; g -> n_comp > 0; g++ ) {
+      if ( g -> n_comp == H -> n_comp && memcmp ( g -> parent_id, H -> parent_id, H -> n_comp * sizeof ( int ) ) == 0 ) { H -> solve = g -> solve; break; }
+    }
+  }
   return H;
 }
 
@@ -39,8 +128,9 @@ void hines_matrix_finalize ( hines_matrix_t * H )
 {
     free ( H -> Ad );
     free ( H -> Api );
-    free ( H -> bu_Ad );
-    free ( H -> bu_Api );
     free ( H -> parent_id );
+    if ( H -> part_ptr  != NULL ) { free ( H -> part_ptr  ); }
+    if ( H -> part_node != NULL ) { free ( H -> part_node ); }
+    if ( H -> root_node != NULL ) { free ( H -> root_node ); }
     H -> n_comp = 0;
 }
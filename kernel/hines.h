@@ -3,9 +3,24 @@
 
 #pragma once
 
+#include "precision.h"
+
 typedef struct {
     int n_comp;
-    double *Ad, *Api;
-    double *bu_Ad, *bu_Api;
+    matrix_t *Ad, *Api;
     int *parent_id;
+    // Multisplit (MULTISPLIT > 1): the tree is cut into a root region around the soma and whole subtrees,
+    // and the subtrees are grouped into n_part parts that are eliminated in parallel.
+    int n_part;                 // 0 == not split
+    int *part_ptr, *part_node;  // nodes of part k == part_node [ part_ptr [ k ] .. part_ptr [ k + 1 ] ) in ascending order, subtree tops excluded
+    int n_root, *root_node;     // nodes whose parent is in the root region (including subtree tops) in ascending order
+    // Straight-line solver of this morphology from hines_gen.h (HINES_GEN == 1), or NULL
+    void ( *solve ) ( matrix_t * __restrict__, const matrix_t * __restrict__, matrix_t * __restrict__ );
 } hines_matrix_t;
+
+// An entry of hines_gen.h: the solver of the morphology with the given parents (Ad, Api, b; the solution overwrites b)
+typedef struct {
+    int n_comp;
+    const int *parent_id;
+    void ( *solve ) ( matrix_t * __restrict__, const matrix_t * __restrict__, matrix_t * __restrict__ );
+} hines_gen_t;
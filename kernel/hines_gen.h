@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+// Generated by nl_hinesgen (make hines); do not edit.
+// No morphologies: every neuron is solved by solve_matrix.
+
+#pragma once
+
+#include "hines.h"
+
+static const hines_gen_t hines_gen [ ] = {
+  { 0, NULL, NULL }
+};
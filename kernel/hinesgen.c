@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+//
+// Generator of hines_gen.h (make hines): a solver specialized to each morphology of a population file.
+// A solver repeats the operations of solve_matrix (solver.c) in the same order, with the parents as literals,
+// so its result is bitwise identical, without the loads of parent_id and the branches on them.
+// Populations with the same morphology share one solver.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "popl.h"
+#include "hines.h"
+#include "config.h"
+
+extern hines_matrix_t *hines_matrix_initialize ( const population_t *, const int );
+extern void           *hines_matrix_finalize ( hines_matrix_t * );
+
+//
+// The compartments are visited in the order of solve_matrix. A run of compartments whose parent is the previous one
+// (an unbranched section) becomes a loop with literal bounds that carries the pivot in registers as solve_matrix does;
+// every other compartment becomes a statement with its parent as a literal.
+//
+static void emit_solver ( const int k, const int n, const int *parent )
+{
+  printf ( "static const int hines_parent_%d [ %d ] = {", k, n );
+  for ( int i = 0; i < n; i++ ) { printf ( "%s%d", ( i == 0 ) ? " " : ( i % 20 == 0 ) ? ",\n  " : ", ", parent [ i ] ); }
+  printf ( " };\n\n" );
+
+  printf ( "static void hines_solve_%d ( matrix_t * __restrict__ Ad, const matrix_t * __restrict__ Api, matrix_t * __restrict__ b )\n{\n", k );
+  if ( n == 1 ) { printf ( "  b [ 0 ] = b [ 0 ] / Ad [ 0 ];\n}\n\n" ); return; }
+
+  // TRIANG, i = n - 1 .. 1; a and r are prev_Ad and prev_b of solve_matrix, reloaded unless i is the parent of i + 1
+  // The first step is evaluated in matrix_t as in solve_matrix
+  printf ( "  double a, r, x;\n  // TRIANG\n" );
+  printf ( "  a = Ad [ %d ] - Api [ %d ] * Api [ %d ] / Ad [ %d ]; Ad [ %d ] = a;\n", parent [ n - 1 ], n - 1, n - 1, n - 1, parent [ n - 1 ] );
+  printf ( "  r = b [ %d ] - b [ %d ] * Api [ %d ] / Ad [ %d ]; b [ %d ] = r;\n", parent [ n - 1 ], n - 1, n - 1, n - 1, parent [ n - 1 ] );
+  for ( int i = n - 2; i > 0; ) {
+    const int reload = ( parent [ i + 1 ] != i );
+    if ( parent [ i ] == i - 1 ) {
+      int lo = i; while ( lo > 1 && parent [ lo - 1 ] == lo - 2 ) { lo--; }
+      if ( reload ) { printf ( "  r = b [ %d ]; a = Ad [ %d ];\n", i, i ); }
+      printf ( "  for ( int i = %d; i >= %d; i-- ) { r = b [ i - 1 ] - r * Api [ i ] / a; a = Ad [ i - 1 ] - Api [ i ] * Api [ i ] / a; Ad [ i - 1 ] = a; b [ i - 1 ] = r; }\n", i, lo );
+      i = lo - 1;
+    } else {
+      const int p = parent [ i ];
+      if ( reload ) { printf ( "  r = b [ %d ]; a = Ad [ %d ];", i, i ); } else { printf ( " " ); }
+      printf ( " r = b [ %d ] - r * Api [ %d ] / a; a = Ad [ %d ] - Api [ %d ] * Api [ %d ] / a; Ad [ %d ] = a; b [ %d ] = r;\n", p, i, p, i, i, p, p );
+      i--;
+    }
+  }
+
+  // FWSUB, i = 1 .. n - 1; x is prev_x of solve_matrix, reloaded unless the parent of i is i - 1
+  printf ( "  // FWSUB\n  b [ 0 ] = b [ 0 ] / Ad [ 0 ]; x = b [ 0 ];\n" );
+  for ( int i = 1; i < n; ) {
+    if ( parent [ i ] == i - 1 ) {
+      int hi = i; while ( hi < n - 1 && parent [ hi + 1 ] == hi ) { hi++; }
+      printf ( "  for ( int i = %d; i <= %d; i++ ) { x = ( b [ i ] - x * Api [ i ] ) / Ad [ i ]; b [ i ] = x; }\n", i, hi );
+      i = hi + 1;
+    } else {
+      printf ( "  x = b [ %d ]; x = ( b [ %d ] - x * Api [ %d ] ) / Ad [ %d ]; b [ %d ] = x;\n", parent [ i ], i, i, i, i );
+      i++;
+    }
+  }
+  printf ( "}\n\n" );
+}
+
+int main ( int argc, char **argv )
+{
+  if ( argc != 2 ) { fprintf ( stderr, "usage: %s <population_csv> > hines_gen.h\n", argv [ 0 ] ); exit ( 1 ); }
+
+  population_t *u = initialize_population ( argv [ 1 ] );
+  hines_matrix_t **H = calloc ( u -> n_popl, sizeof ( hines_matrix_t * ) );
+  int *solver = calloc ( u -> n_popl, sizeof ( int ) ); // solver of each population; -1 == shared with an earlier one
+
+  printf ( "// SPDX-License-Identifier: GPL-2.0-only\n" );
+  printf ( "// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>\n\n" );
+  printf ( "// Generated by nl_hinesgen from %s (make hines); do not edit.\n\n", argv [ 1 ] );
+  printf ( "#pragma once\n\n#include \"hines.h\"\n\n" );
+
+  int n_solver = 0;
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) {
+    H [ pid ] = hines_matrix_initialize ( u, pid );
+    solver [ pid ] = n_solver;
+    for ( int q = 0; q < pid; q++ ) {
+      if ( solver [ q ] >= 0 && H [ q ] -> n_comp == H [ pid ] -> n_comp
+	   && memcmp ( H [ q ] -> parent_id, H [ pid ] -> parent_id, H [ pid ] -> n_comp * sizeof ( int ) ) == 0 ) { solver [ pid ] = -1; break; }
+    }
+    if ( solver [ pid ] < 0 ) { continue; }
+    printf ( "//\n// pid %d: %d compartments\n//\n", pid, H [ pid ] -> n_comp );
+    emit_solver ( n_solver++, H [ pid ] -> n_comp, H [ pid ] -> parent_id );
+  }
+
+  printf ( "static const hines_gen_t hines_gen [ ] = {\n" );
+  for ( int pid = 0, k = 0; pid < u -> n_popl; pid++ ) {
+    if ( solver [ pid ] < 0 ) { continue; }
+    printf ( "  { %d, hines_parent_%d, hines_solve_%d },\n", H [ pid ] -> n_comp, k, k );
+    k++;
+  }
+  printf ( "  { 0, NULL, NULL }\n};\n" );
+
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) { hines_matrix_finalize ( H [ pid ] ); free ( H [ pid ] ); }
+  free ( solver );
+  free ( H );
+  finalize_population ( u );
+  return 0;
+}
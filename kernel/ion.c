@@ -5,66 +5,56 @@
 #include <stdlib.h>
 #include "ion.h"
 #include "ion_func.h"
+#include "ion_gen.h"
 #include "popl.h"
 #include "neuron.h"
 #include "config.h"
 
-ion_t *initialize_ion ( const neuron_t *n )
+// Steady state of NaV; state s is ion [ s * stride ]
+static void init_nav ( const double _v, state_t *ion, const int stride )
+{
+  double vca [ N_STATE_NAV ] [ N_STATE_NAV ] = {};
+  double vcb [ N_STATE_NAV ] = {};
+  Init_Nav_param ( _v, vca );
+  for ( int col = 0; col < N_STATE_NAV; col++ ) { vca [ N_STATE_NAV - 1 ] [ col ] = 1.0; } // I6 channel 
+  vcb [ N_STATE_NAV - 1 ] = 1.0;
+  gaussian_elimination ( N_STATE_NAV, vca, vcb );
+  ion [ C1_NaV * stride ] = vcb [ 0  ];
+  ion [ C2_NaV * stride ] = vcb [ 1  ];
+  ion [ C3_NaV * stride ] = vcb [ 2  ];
+  ion [ C4_NaV * stride ] = vcb [ 3  ];
+  ion [ C5_NaV * stride ] = vcb [ 4  ];
+  ion [ I1_NaV * stride ] = vcb [ 5  ];
+  ion [ I2_NaV * stride ] = vcb [ 6  ];
+  ion [ I3_NaV * stride ] = vcb [ 7  ];
+  ion [ I4_NaV * stride ] = vcb [ 8  ];
+  ion [ I5_NaV * stride ] = vcb [ 9  ];
+  ion [ I6_NaV * stride ] = vcb [ 10 ];
+  ion [ OO_NaV * stride ] = vcb [ 11 ];
+}
+
+ion_t *initialize_ion ( const population_t *u, const neuron_t *n )
 {
   ion_t *i = calloc ( 1, sizeof ( ion_t ) );
 
   if ( n -> n_neuron == 0 ) { return i; }
 
+  int n_gated = 0; // # neurons (perisomatic) or # compartments (all-active) that have gates
+  for ( int li = 0; li < n -> n_neuron; li++ ) { n_gated += GATE_STRIDE ( u, n -> pid [ li ] ); }
+
   i -> n_neuron = n -> n_neuron;
-  i -> gate = calloc ( N_GATEVAL * i -> n_neuron, sizeof ( double ) );
+  i -> gate = calloc ( N_GATEVAL * n_gated, sizeof ( state_t ) );
+  ion_lut_initialize ( );
 
   for ( int li = 0; li < i -> n_neuron; li++ ) {
-    const double _v  = n ->  v [ n -> sid [ li ] + 0 ]; // compartment id 0 == SOMA
-    const double _ca = n -> ca [ n -> sid [ li ] + 0 ]; // compartment id 0 == SOMA
-    double *ion = &i -> gate [ N_GATEVAL * li ];
-    ion [ M_NATS ] = inf_m_NaTs  ( _v );
-    ion [ H_NATS ] = inf_h_NaTs  ( _v );
-    ion [ M_NATA ] = inf_m_NaTa  ( _v );
-    ion [ H_NATA ] = inf_h_NaTa  ( _v );
-    ion [ H_NAP  ] = inf_h_Nap   ( _v );
-    ion [ M_KV2  ] = inf_m_Kv2   ( _v );
-    ion [ H1_KV2 ] = inf_h_Kv2   ( _v );
-    ion [ H2_KV2 ] = inf_h_Kv2   ( _v );
-    ion [ M_KV3  ] = inf_m_Kv3   ( _v );
-    ion [ M_KP   ] = inf_m_KP    ( _v );
-    ion [ H_KP   ] = inf_h_KP    ( _v );
-    ion [ M_KT   ] = inf_m_KT    ( _v );
-    ion [ H_KT   ] = inf_h_KT    ( _v );
-    ion [ M_KD   ] = inf_m_Kd    ( _v );
-    ion [ H_KD   ] = inf_h_Kd    ( _v );
-    ion [ M_IM   ] = inf_m_Im    ( _v );
-    ion [ M_IMV2 ] = inf_m_Imv2  ( _v );
-    ion [ M_IH   ] = inf_m_Ih    ( _v );
-    ion [ Z_SK   ] = inf_z_SK    ( _v, _ca );
-    ion [ M_CAHVA ] = inf_m_CaHVA ( _v );
-    ion [ H_CAHVA ] = inf_h_CaHVA ( _v );
-    ion [ M_CALVA ] = inf_m_CaLVA ( _v );
-    ion [ H_CALVA ] = inf_h_CaLVA ( _v );
-
-    { // NaV
-      double vca [ N_STATE_NAV ] [ N_STATE_NAV ] = {};
-      double vcb [ N_STATE_NAV ] = {};
-      Init_Nav_param ( _v, vca );
-      for ( int col = 0; col < N_STATE_NAV; col++ ) { vca [ N_STATE_NAV - 1 ] [ col ] = 1.0; } // I6 channel 
-      vcb [ N_STATE_NAV - 1 ] = 1.0;
-      gaussian_elimination ( N_STATE_NAV, vca, vcb );
-      ion [ C1_NaV ] = vcb [ 0  ];
-      ion [ C2_NaV ] = vcb [ 1  ];
-      ion [ C3_NaV ] = vcb [ 2  ];
-      ion [ C4_NaV ] = vcb [ 3  ];
-      ion [ C5_NaV ] = vcb [ 4  ];
-      ion [ I1_NaV ] = vcb [ 5  ];
-      ion [ I2_NaV ] = vcb [ 6  ];
-      ion [ I3_NaV ] = vcb [ 7  ];
-      ion [ I4_NaV ] = vcb [ 8  ];
-      ion [ I5_NaV ] = vcb [ 9  ];
-      ion [ I6_NaV ] = vcb [ 10 ];
-      ion [ OO_NaV ] = vcb [ 11 ];
+    const int pid = n -> pid [ li ], stride = GATE_STRIDE ( u, pid );
+    for ( int j = 0; j < stride; j++ ) { // compartment id 0 == SOMA
+      const double _v  = n ->  v [ n -> sid [ li ] + j ];
+      const double _ca = n -> ca [ n -> sid [ li ] + j ];
+      state_t *ion = &i -> gate [ GATE_OFFSET ( n, li ) + j ];
+      init_gates ( _v, _ca, ion, stride );
+      const int type = u -> type [ u -> cid [ pid ] + j ];
+      if ( ALLACTIVE == 0 || u -> gdens [ G_NAV + N_GBAR * ( type + N_COMPTYPE * pid ) ] != 0.0 ) { init_nav ( _v, ion, stride ); } // all-active: only where NaV is
     }
   }
   
@@ -77,38 +67,147 @@ void finalize_ion ( ion_t *i )
   free ( i );
 }
 
-void update_ion ( const int id, const neuron_t * __restrict__ n, const double * __restrict__ v, ion_t * __restrict__ i, const double dt )
+//
+// Channel-set specialization.
+// The bodies below and update_gates of ion_gen.h evaluate only the channels whose bit is set in mask (bit g == gbar [ g ] != 0).
+// They are always inlined, so each variant of CHANNEL_MASKS (config.h) is compiled with a constant mask and the dead
+// channels vanish; any other mask falls back to the same body with the mask tested at run time.
+// Gates of a dead channel keep their initial values and are never read.
+//
+#define ACTIVE(g) ( ( mask ) & CHANNEL ( g ) )
+
+static inline __attribute__ ( ( always_inline ) ) void update_ion_kernel ( const unsigned mask, const double _v, const double _ca, state_t * __restrict__ ion, const double dt )
+{
+  if ( ACTIVE ( G_NAV ) ) { // NaV is integrated in double, also when the gates are stored in float
+    double s [ N_STATE_NAV ];
+    for ( int k = 0; k < N_STATE_NAV; k++ ) { s [ k ] = ion [ OO_NaV + k ]; }
+    Nav_update ( _v, dt, &s [ 0 ], &s [ 1 ], &s [ 2 ], &s [ 3 ], &s [ 4 ], &s [ 5 ], &s [ 6 ], &s [ 7 ], &s [ 8 ], &s [ 9 ], &s [ 10 ], &s [ 11 ] );
+    for ( int k = 0; k < N_STATE_NAV; k++ ) { ion [ OO_NaV + k ] = s [ k ]; }
+  }
+
+  update_gates ( mask, _v, _ca, ion, dt );
+}
+
+static inline __attribute__ ( ( always_inline ) ) double i_ca_kernel ( const unsigned mask, const double * __restrict__ gbar, const state_t * __restrict__ ion )
 {
+  double g = 0.0;
+  if ( ACTIVE ( G_CAHVA ) ) { g += gbar [ G_CAHVA ] * ion [ M_CAHVA ] * ion [ M_CAHVA ] * ion [ H_CAHVA ]; }
+  if ( ACTIVE ( G_CALVA ) ) { g += gbar [ G_CALVA ] * ion [ M_CALVA ] * ion [ M_CALVA ] * ion [ H_CALVA ]; }
+  return g;
+}
+
+static inline __attribute__ ( ( always_inline ) ) void lhs_and_rhs_kernel ( const unsigned mask, const double _v, const double _ca, const double * __restrict__ gbar, const state_t * __restrict__ ion, double * __restrict__ lhs, double * __restrict__ rhs )
+{
+  double _l = 0.0, _r = 0.0, _c;
+  if ( ACTIVE ( G_NAV   ) ) { _c = gbar [ G_NAV   ] * ion [ OO_NaV ];                                                                  _l += _c; _r += _c * V_NA; }
+  if ( ACTIVE ( G_NATS  ) ) { _c = gbar [ G_NATS  ] * ion [ M_NATS ] * ion [ M_NATS ] * ion [ M_NATS ] * ion [ H_NATS ];               _l += _c; _r += _c * V_NA; }
+  if ( ACTIVE ( G_NATA  ) ) { _c = gbar [ G_NATA  ] * ion [ M_NATA ] * ion [ M_NATA ] * ion [ M_NATA ] * ion [ H_NATA ];               _l += _c; _r += _c * V_NA; }
+  if ( ACTIVE ( G_NAP   ) ) { _c = gbar [ G_NAP   ] * inf_m_Nap ( _v ) * ion [ H_NAP ];                                                _l += _c; _r += _c * V_NA; }
+  if ( ACTIVE ( G_KV2   ) ) { _c = gbar [ G_KV2   ] * ion [ M_KV2 ] * ion [ M_KV2 ] * ( 0.5 * ion [ H1_KV2 ] + 0.5 * ion [ H2_KV2 ] ); _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_KV3   ) ) { _c = gbar [ G_KV3   ] * ion [ M_KV3 ];                                                                   _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_KP    ) ) { _c = gbar [ G_KP    ] * ion [ M_KP ] * ion [ M_KP ] * ion [ H_KP ];                                      _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_KT    ) ) { _c = gbar [ G_KT    ] * ion [ M_KT ] * ion [ M_KT ] * ion [ M_KT ] * ion [ M_KT ] * ion [ H_KT ];        _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_KD    ) ) { _c = gbar [ G_KD    ] * ion [ M_KD ] * ion [ H_KD ];                                                     _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_IM    ) ) { _c = gbar [ G_IM    ] * ion [ M_IM ];                                                                    _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_IMV2  ) ) { _c = gbar [ G_IMV2  ] * ion [ M_IMV2 ];                                                                  _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_IH    ) ) { _c = gbar [ G_IH    ] * ion [ M_IH ];                                                                    _l += _c; _r += _c * V_HCN; }
+  if ( ACTIVE ( G_SK    ) ) { _c = gbar [ G_SK    ] * ion [ Z_SK ];                                                                    _l += _c; _r += _c * V_K; }
+  if ( ACTIVE ( G_CAHVA ) ) { _c = gbar [ G_CAHVA ] * ion [ M_CAHVA ] * ion [ M_CAHVA ] * ion [ H_CAHVA ];                             _l += _c; _r += _c * rev_ca ( _ca ); }
+  if ( ACTIVE ( G_CALVA ) ) { _c = gbar [ G_CALVA ] * ion [ M_CALVA ] * ion [ M_CALVA ] * ion [ H_CALVA ];                             _l += _c; _r += _c * rev_ca ( _ca ); }
+  *lhs = _l;
+  *rhs = _r;
+}
+
+//
+// All-active: the same per compartment. Channel g is evaluated in the compartments comp [ ptr [ g ] .. ptr [ g + 1 ] - 1 ]
+// (population_t::chan_comp), and its conductance is the density of the compartment type times the area.
+// Gate s of compartment j is ion [ s * stride + j ] (GATE_STRIDE).
+//
+static inline __attribute__ ( ( always_inline ) ) void update_ion_comp_kernel ( const unsigned mask, const int * __restrict__ ptr, const int * __restrict__ comp,
+									      const matrix_t * __restrict__ v, const double * __restrict__ ca, state_t * __restrict__ ion, const int stride, const double dt )
+{
+  if ( ACTIVE ( G_NAV ) ) {
+    for ( int k = ptr [ G_NAV ]; k < ptr [ G_NAV + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double s [ N_STATE_NAV ];
+      for ( int l = 0; l < N_STATE_NAV; l++ ) { s [ l ] = ion [ ( OO_NaV + l ) * stride + j ]; }
+      Nav_update ( v [ j ], dt, &s [ 0 ], &s [ 1 ], &s [ 2 ], &s [ 3 ], &s [ 4 ], &s [ 5 ], &s [ 6 ], &s [ 7 ], &s [ 8 ], &s [ 9 ], &s [ 10 ], &s [ 11 ] );
+      for ( int l = 0; l < N_STATE_NAV; l++ ) { ion [ ( OO_NaV + l ) * stride + j ] = s [ l ]; }
+    }
+  }
+
+  update_gates_comp ( mask, ptr, comp, v, ca, ion, stride, dt );
+}
+
+#define S(s) ion [ ( s ) * stride + j ]
+#define G(g) gdens [ ( g ) + N_GBAR * type [ j ] ] * area [ j ] * 1e3 /* CONVERSION: 1e3 from S to mS */
+// Conductance _c of the channel g in every compartment j of its list, added to Ad [ j ] and b [ j ] with the reversal potential e
+#define COMP_TERM(g,gates,e) if ( ACTIVE ( g ) ) { for ( int k = ptr [ g ]; k < ptr [ g + 1 ]; k++ ) { const int j = comp [ k ]; const double _c = G ( g ) * gates; Ad [ j ] += _c; b [ j ] += _c * ( e ); } }
+
+static inline __attribute__ ( ( always_inline ) ) void lhs_and_rhs_comp_kernel ( const unsigned mask, const int * __restrict__ ptr, const int * __restrict__ comp, const int * __restrict__ type,
+									       const double * __restrict__ area, const double * __restrict__ gdens, const double * __restrict__ v, const double * __restrict__ ca,
+									       const state_t * __restrict__ ion, const int stride, matrix_t * __restrict__ Ad, matrix_t * __restrict__ b )
+{
+  COMP_TERM ( G_NAV,   S ( OO_NaV ),                                                 V_NA );
+  COMP_TERM ( G_NATS,  S ( M_NATS ) * S ( M_NATS ) * S ( M_NATS ) * S ( H_NATS ),      V_NA );
+  COMP_TERM ( G_NATA,  S ( M_NATA ) * S ( M_NATA ) * S ( M_NATA ) * S ( H_NATA ),      V_NA );
+  COMP_TERM ( G_NAP,   inf_m_Nap ( v [ j ] ) * S ( H_NAP ),                           V_NA );
+  COMP_TERM ( G_KV2,   S ( M_KV2 ) * S ( M_KV2 ) * ( 0.5 * S ( H1_KV2 ) + 0.5 * S ( H2_KV2 ) ), V_K );
+  COMP_TERM ( G_KV3,   S ( M_KV3 ),                                                  V_K );
+  COMP_TERM ( G_KP,    S ( M_KP ) * S ( M_KP ) * S ( H_KP ),                         V_K );
+  COMP_TERM ( G_KT,    S ( M_KT ) * S ( M_KT ) * S ( M_KT ) * S ( M_KT ) * S ( H_KT ), V_K );
+  COMP_TERM ( G_KD,    S ( M_KD ) * S ( H_KD ),                                      V_K );
+  COMP_TERM ( G_IM,    S ( M_IM ),                                                   V_K );
+  COMP_TERM ( G_IMV2,  S ( M_IMV2 ),                                                 V_K );
+  COMP_TERM ( G_IH,    S ( M_IH ),                                                   V_HCN );
+  COMP_TERM ( G_SK,    S ( Z_SK ),                                                   V_K );
+  COMP_TERM ( G_CAHVA, S ( M_CAHVA ) * S ( M_CAHVA ) * S ( H_CAHVA ),                rev_ca ( ca [ j ] ) );
+  COMP_TERM ( G_CALVA, S ( M_CALVA ) * S ( M_CALVA ) * S ( H_CALVA ),                rev_ca ( ca [ j ] ) );
+}
+
+// [Ca2+] of the compartments with a Ca2+ channel (CA_COMP); the others have no Ca2+ current and stay at rest
+static void update_ca_comp ( const int * __restrict__ ptr, const int * __restrict__ comp, const int * __restrict__ type, const double * __restrict__ area, const double * __restrict__ gdens,
+			     const double * __restrict__ gamma, const double * __restrict__ decay, const double * __restrict__ v, double * __restrict__ ca,
+			     const state_t * __restrict__ ion, const int stride, const double dt )
+{
+  for ( int k = ptr [ CA_COMP ]; k < ptr [ CA_COMP + 1 ]; k++ ) {
+    const int j = comp [ k ];
+    const double g_ca = G ( G_CAHVA ) * S ( M_CAHVA ) * S ( M_CAHVA ) * S ( H_CAHVA ) + G ( G_CALVA ) * S ( M_CALVA ) * S ( M_CALVA ) * S ( H_CALVA );
+    const double i_ca =  (1e-3 * ( v [ j ] - rev_ca ( ca [ j ] ) ) * g_ca ) / area [ j ];
+    ca [ j ] += dt * dcadt ( ca [ j ], i_ca, gamma [ type [ j ] ], decay [ type [ j ] ] );
+  }
+}
+
+#undef COMP_TERM
+#undef G
+#undef S
+
+// One case per mask of CHANNEL_MASKS; the default case is the run-time mask
+#define CHANNEL_VARIANT(m) case ( m ): CHANNEL_CALL ( ( m ) ); break;
+#define CHANNEL_DISPATCH(mask) switch ( mask ) { CHANNEL_MASKS default: CHANNEL_CALL ( mask ); }
+
+void update_ion ( const int id, const population_t * __restrict__ u, const neuron_t * __restrict__ n, const matrix_t * __restrict__ v, ion_t * __restrict__ i, const double dt )
+{
+  if ( ALLACTIVE == 1 ) {
+    const int pid = n -> pid [ id ];
+    const int *ptr = &u -> chan_ptr [ N_CHAN_LIST * pid ];
+    const double *ca = &n -> ca [ n -> sid [ id ] ];
+    state_t *ion = &i -> gate [ GATE_OFFSET ( n, id ) ];
+    const int stride = GATE_STRIDE ( u, pid );
+#define CHANNEL_CALL(m) update_ion_comp_kernel ( ( m ), ptr, u -> chan_comp, v, ca, ion, stride, dt )
+    CHANNEL_DISPATCH ( u -> channel [ pid ] );
+#undef CHANNEL_CALL
+    return;
+  }
+
   const double _v  = v  [ 0 ];
   const double _ca = n -> ca [ n -> sid [ id ] + 0 ];
-  double *ion = &i -> gate [ N_GATEVAL * id ];
-
-  Nav_update ( _v, &ion [ OO_NaV ], &ion [ C1_NaV ], &ion [ C2_NaV ], &ion [ C3_NaV ], &ion [ C4_NaV ], &ion [ C5_NaV ],
-	           &ion [ I1_NaV ], &ion [ I2_NaV ], &ion [ I3_NaV ], &ion [ I4_NaV ], &ion [ I5_NaV ], &ion [ I6_NaV ] );
-
-  ion [ M_NATS ]  = inf_m_NaTs ( _v )      + ( ion [ M_NATS ]  - inf_m_NaTs ( _v ) )    * exp ( - dt / tau_m_NaTs   ( _v ) );
-  ion [ H_NATS ]  = inf_h_NaTs ( _v )      + ( ion [ H_NATS ]  - inf_h_NaTs ( _v ) )    * exp ( - dt / tau_h_NaTs   ( _v ) );
-  ion [ M_NATA ]  = inf_m_NaTa ( _v )      + ( ion [ M_NATA ]  - inf_m_NaTa ( _v ) )    * exp ( - dt / tau_m_NaTa   ( _v ) );
-  ion [ H_NATA ]  = inf_h_NaTa ( _v )      + ( ion [ H_NATA ]  - inf_h_NaTa ( _v ) )    * exp ( - dt / tau_h_NaTa   ( _v ) );
-  ion [ H_NAP  ]  = inf_h_Nap  ( _v )      + ( ion [ H_NAP  ]  - inf_h_Nap  ( _v ) )    * exp ( - dt / tau_h_Nap    ( _v ) );
-  ion [ M_KV2  ]  = inf_m_Kv2  ( _v )      + ( ion [ M_KV2  ]  - inf_m_Kv2  ( _v ) )    * exp ( - dt / tau_m_Kv2    ( _v ) );
-  ion [ H1_KV2 ]  = inf_h_Kv2  ( _v )      + ( ion [ H1_KV2 ]  - inf_h_Kv2  ( _v ) )    * exp ( - dt / tau_h1_Kv2   ( _v ) );
-  ion [ H2_KV2 ]  = inf_h_Kv2  ( _v )      + ( ion [ H2_KV2 ]  - inf_h_Kv2  ( _v ) )    * exp ( - dt / tau_h2_Kv2   ( _v ) );
-  ion [ M_KV3  ]  = inf_m_Kv3  ( _v )      + ( ion [ M_KV3  ]  - inf_m_Kv3  ( _v ) )    * exp ( - dt / tau_m_Kv3    ( _v ) );
-  ion [ M_KP   ]  = inf_m_KP   ( _v )      + ( ion [ M_KP   ]  - inf_m_KP   ( _v ) )    * exp ( - dt / tau_m_KP     ( _v ) );
-  ion [ H_KP   ]  = inf_h_KP   ( _v )      + ( ion [ H_KP   ]  - inf_h_KP   ( _v ) )    * exp ( - dt / tau_h_KP     ( _v ) );
-  ion [ M_KT   ]  = inf_m_KT   ( _v )      + ( ion [ M_KT   ]  - inf_m_KT   ( _v ) )    * exp ( - dt / tau_m_KT     ( _v ) );
-  ion [ H_KT   ]  = inf_h_KT   ( _v )      + ( ion [ H_KT   ]  - inf_h_KT   ( _v ) )    * exp ( - dt / tau_h_KT     ( _v ) );
-  ion [ M_KD   ]  = inf_m_Kd   ( _v )      + ( ion [ M_KD   ]  - inf_m_Kd   ( _v ) )    * exp ( - dt / tau_m_Kd     ( _v ) );
-  ion [ H_KD   ]  = inf_h_Kd   ( _v )      + ( ion [ H_KD   ]  - inf_h_Kd   ( _v ) )    * exp ( - dt / tau_h_Kd     ( _v ) );
-  ion [ M_IM   ]  = inf_m_Im   ( _v )      + ( ion [ M_IM   ]  - inf_m_Im   ( _v ) )    * exp ( - dt / tau_m_Im     ( _v ) );
-  ion [ M_IMV2 ]  = inf_m_Imv2 ( _v )      + ( ion [ M_IMV2 ]  - inf_m_Imv2 ( _v ) )    * exp ( - dt / tau_m_Imv2   ( _v ) );
-  ion [ M_IH   ]  = inf_m_Ih   ( _v )      + ( ion [ M_IH   ]  - inf_m_Ih   ( _v ) )    * exp ( - dt / tau_m_Ih     ( _v ) );
-  ion [ Z_SK   ]  = inf_z_SK   ( _v, _ca ) + ( ion [ Z_SK   ]  - inf_z_SK ( _v, _ca ) ) * exp ( - dt / tau_z_SK     ( _v ) );
-  ion [ M_CAHVA ] = inf_m_CaHVA ( _v )     + ( ion [ M_CAHVA ] - inf_m_CaHVA ( _v ) )   * exp ( - dt / tau_m_CaHVA  ( _v ) );
-  ion [ H_CAHVA ] = inf_h_CaHVA ( _v )     + ( ion [ H_CAHVA ] - inf_h_CaHVA ( _v ) )   * exp ( - dt / tau_h_CaHVA  ( _v ) );
-  ion [ M_CALVA ] = inf_m_CaLVA ( _v )     + ( ion [ M_CALVA ] - inf_m_CaLVA ( _v ) )   * exp ( - dt / tau_m_CaLVA  ( _v ) );
-  ion [ H_CALVA ] = inf_h_CaLVA ( _v )     + ( ion [ H_CALVA ] - inf_h_CaLVA ( _v ) )   * exp ( - dt / tau_h_CaLVA  ( _v ) );
+  state_t *ion = &i -> gate [ N_GATEVAL * id ];
+  const unsigned mask = u -> channel [ n -> pid [ id ] ];
+
+#define CHANNEL_CALL(m) update_ion_kernel ( ( m ), _v, _ca, ion, dt )
+  CHANNEL_DISPATCH ( mask );
+#undef CHANNEL_CALL
 }
 
 void update_ca ( const int id, const population_t * __restrict__ u, const ion_t * __restrict__ i, neuron_t * __restrict__ n, const double dt )
@@ -116,7 +215,15 @@ void update_ca ( const int id, const population_t * __restrict__ u, const ion_t
   const int sid = n -> sid [ id ];
   const int pid = n -> pid [ id ];
   const double *gbar = &u -> gbar [ N_GBAR * pid ]; // perisomatic
-  const double *ion  = &i -> gate [ N_GATEVAL * id ];
+  const state_t *ion  = &i -> gate [ N_GATEVAL * id ];
+  const unsigned mask = u -> channel [ pid ];
+
+  if ( ALLACTIVE == 1 ) {
+    const int cid = u -> cid [ pid ];
+    update_ca_comp ( &u -> chan_ptr [ N_CHAN_LIST * pid ], u -> chan_comp, &u -> type [ cid ], &u -> area [ cid ], &u -> gdens [ N_GBAR * N_COMPTYPE * pid ],
+		     &u -> gamma [ N_COMPTYPE * pid ], &u -> decay [ N_COMPTYPE * pid ], &n -> v [ sid ], &n -> ca [ sid ], &i -> gate [ GATE_OFFSET ( n, id ) ], GATE_STRIDE ( u, pid ), dt );
+    return;
+  }
 
   {
     const double v  = n -> v  [ sid ];
@@ -124,35 +231,40 @@ void update_ca ( const int id, const population_t * __restrict__ u, const ion_t
     const double area  = u -> area [ u -> cid [ pid ] ];
     const double gamma = u -> gamma [ SOMA + N_COMPTYPE * pid ]; // perisomatic
     const double decay = u -> decay [ SOMA + N_COMPTYPE * pid ]; // perisomatic
-    const double i_ca =  (1e-3 * ( v - rev_ca ( ca ) ) * ( gbar [ G_CAHVA ] * ion [ M_CAHVA ] * ion [ M_CAHVA ] * ion [ H_CAHVA ]
-							   + gbar [ G_CALVA ] * ion [ M_CALVA ] * ion [ M_CALVA ] * ion [ H_CALVA ] ) ) / area;
+    double g_ca = 0.0;
+#define CHANNEL_CALL(m) g_ca = i_ca_kernel ( ( m ), gbar, ion )
+    CHANNEL_DISPATCH ( mask );
+#undef CHANNEL_CALL
+    const double i_ca =  (1e-3 * ( v - rev_ca ( ca ) ) * g_ca ) / area;
     n -> ca [ sid ] += dt * dcadt ( ca, i_ca, gamma, decay );
   }
 }
 
-void calc_lhs_and_rhs ( const population_t * __restrict__ u, const neuron_t * __restrict__ n, const ion_t * __restrict__ i, const int pid, const int id, double * __restrict__ lhs, double * __restrict__ rhs )
+// Adds the channel conductances (Ad) and currents (b) of neuron id to its linear system
+void calc_lhs_and_rhs ( const population_t * __restrict__ u, const neuron_t * __restrict__ n, const ion_t * __restrict__ i, const int pid, const int id, matrix_t * __restrict__ Ad, matrix_t * __restrict__ b )
 {
+  if ( ALLACTIVE == 1 ) {
+    const int cid = u -> cid [ pid ], sid = n -> sid [ id ];
+    const int *ptr = &u -> chan_ptr [ N_CHAN_LIST * pid ];
+    const int *type = &u -> type [ cid ];
+    const double *area = &u -> area [ cid ], *gdens = &u -> gdens [ N_GBAR * N_COMPTYPE * pid ];
+    const state_t *ion = &i -> gate [ GATE_OFFSET ( n, id ) ];
+    const int stride = GATE_STRIDE ( u, pid );
+#define CHANNEL_CALL(m) lhs_and_rhs_comp_kernel ( ( m ), ptr, u -> chan_comp, type, area, gdens, &n -> v [ sid ], &n -> ca [ sid ], ion, stride, Ad, b )
+    CHANNEL_DISPATCH ( u -> channel [ pid ] );
+#undef CHANNEL_CALL
+    return;
+  }
+
   const double _v  = n -> v  [ n -> sid [ id ] + 0 ];
   const double _ca = n -> ca [ n -> sid [ id ] + 0 ];
-  double *ion  = &i -> gate [ N_GATEVAL * id ];
-  double *gbar = &u -> gbar [ N_GBAR * pid ]; // perisomatic
-  double _l = 0.0, _r = 0.0;
-  double \
-  _c = gbar [ G_NAV   ] * ion [ OO_NaV ];                                                                  _l += _c; _r += _c * V_NA;
-  _c = gbar [ G_NATS  ] * ion [ M_NATS ] * ion [ M_NATS ] * ion [ M_NATS ] * ion [ H_NATS ];               _l += _c; _r += _c * V_NA;
-  _c = gbar [ G_NATA  ] * ion [ M_NATA ] * ion [ M_NATA ] * ion [ M_NATA ] * ion [ H_NATA ];               _l += _c; _r += _c * V_NA;
-  _c = gbar [ G_NAP   ] * inf_m_Nap ( _v ) * ion [ H_NAP ];                                                _l += _c; _r += _c * V_NA;
-  _c = gbar [ G_KV2   ] * ion [ M_KV2 ] * ion [ M_KV2 ] * ( 0.5 * ion [ H1_KV2 ] + 0.5 * ion [ H2_KV2 ] ); _l += _c; _r += _c * V_K;
-  _c = gbar [ G_KV3   ] * ion [ M_KV3 ];                                                                   _l += _c; _r += _c * V_K;
-  _c = gbar [ G_KP    ] * ion [ M_KP ] * ion [ M_KP ] * ion [ H_KP ];                                      _l += _c; _r += _c * V_K;
-  _c = gbar [ G_KT    ] * ion [ M_KT ] * ion [ M_KT ] * ion [ M_KT ] * ion [ M_KT ] * ion [ H_KT ];        _l += _c; _r += _c * V_K;
-  _c = gbar [ G_KD    ] * ion [ M_KD ] * ion [ H_KD ];                                                     _l += _c; _r += _c * V_K;
-  _c = gbar [ G_IM    ] * ion [ M_IM ];                                                                    _l += _c; _r += _c * V_K;
-  _c = gbar [ G_IMV2  ] * ion [ M_IMV2 ];                                                                  _l += _c; _r += _c * V_K;
-  _c = gbar [ G_IH    ] * ion [ M_IH ];                                                                    _l += _c; _r += _c * V_HCN;
-  _c = gbar [ G_SK    ] * ion [ Z_SK ];                                                                    _l += _c; _r += _c * V_K;
-  _c = gbar [ G_CAHVA ] * ion [ M_CAHVA ] * ion [ M_CAHVA ] * ion [ H_CAHVA ];                             _l += _c; _r += _c * rev_ca ( _ca );
-  _c = gbar [ G_CALVA ] * ion [ M_CALVA ] * ion [ M_CALVA ] * ion [ H_CALVA ];                             _l += _c; _r += _c * rev_ca ( _ca );
-  *lhs = _l;
-  *rhs = _r;
+  const state_t *ion  = &i -> gate [ N_GATEVAL * id ];
+  const double *gbar = &u -> gbar [ N_GBAR * pid ]; // perisomatic
+  double lhs = 0.0, rhs = 0.0;
+
+#define CHANNEL_CALL(m) lhs_and_rhs_kernel ( ( m ), _v, _ca, gbar, ion, &lhs, &rhs )
+  CHANNEL_DISPATCH ( u -> channel [ pid ] );
+#undef CHANNEL_CALL
+  Ad [ 0 ] += lhs;
+  b [ 0 ] += rhs;
 }
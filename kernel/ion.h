@@ -6,6 +6,8 @@
 #include <stdio.h>
 #include "popl.h"
 #include "neuron.h"
+#include "precision.h"
+#include "config.h"
 
 #define V_NA    (  53.0  )
 #define V_K     ( -107.0 )
@@ -13,15 +15,24 @@
 
 #define N_STATE_NAV 12
 typedef enum { G_NAV, G_NATS, G_NATA, G_NAP, G_KV2, G_KV3, G_KP, G_KT, G_KD, G_IM, G_IMV2, G_IH, G_SK, G_CAHVA, G_CALVA, N_GBAR } ion_gbar_t;
+#define CHANNEL(g) ( 1u << ( g ) ) // bit of a channel in population_t::channel
+#define ALL_CHANNELS ( CHANNEL ( N_GBAR ) - 1 )
+#define CA_COMP ( N_GBAR ) // all-active: list of the compartments with a Ca2+ channel, after the lists of the channels
+#define N_CHAN_LIST ( N_GBAR + 1 )
 typedef enum { M_NATS, H_NATS, M_NATA, H_NATA, H_NAP, M_KV2, H1_KV2, H2_KV2, M_KV3, M_KP, H_KP, M_KT, H_KT, M_KD, H_KD, M_IM, M_IMV2, M_IH, Z_SK, M_CAHVA, H_CAHVA, M_CALVA, H_CALVA, OO_NaV, C1_NaV, C2_NaV, C3_NaV, C4_NaV, C5_NaV, I1_NaV, I2_NaV, I3_NaV, I4_NaV, I5_NaV, I6_NaV, N_GATEVAL } ion_gateval_t;
 
 typedef struct {
-  double *gate; // size == # neurons * N_GATEVAL // perisomatic
+  state_t *gate; // size == # neurons * N_GATEVAL (perisomatic); # compartments * N_GATEVAL (all-active)
   int n_neuron;
 } ion_t;
 
-extern ion_t *initialize_ion ( const neuron_t * );
+// The gates of neuron id start at gate [ GATE_OFFSET ]: N_GATEVAL values (perisomatic), or N_GATEVAL rows of
+// the compartments of the neuron (all-active), i.e. gate s of compartment j is at s * GATE_STRIDE + j
+#define GATE_OFFSET(n,id)  ( N_GATEVAL * ( ( ALLACTIVE == 1 ) ? ( n ) -> sid [ id ] : ( id ) ) )
+#define GATE_STRIDE(u,pid) ( ( ALLACTIVE == 1 ) ? ( u ) -> n_comp [ pid ] : 1 )
+
+extern ion_t *initialize_ion ( const population_t *, const neuron_t * );
 extern void finalize_ion ( ion_t * );
-extern void update_ion ( const int, const neuron_t *, const double *, ion_t *, const double );
+extern void update_ion ( const int, const population_t *, const neuron_t *, const matrix_t *, ion_t *, const double );
 extern void update_ca ( const int, const population_t *, const ion_t *, neuron_t *, const double );
-extern void calc_lhs_and_rhs ( const population_t *, const neuron_t *, const ion_t *, const int, const int, double *, double * );
+extern void calc_lhs_and_rhs ( const population_t *, const neuron_t *, const ion_t *, const int, const int, matrix_t *, matrix_t * );
@@ -30,359 +30,15 @@ static double vtrap (const double x, const double y){
   }
 }
 
-static double alpha_m_NaTs ( const double v ) {
-  const double malphaF = 0.182;
-  const double mvhalf  = -40.0; // (mV)
-  const double mk      = 6.0; // (mV)
-  return malphaF * vtrap ( - ( v - mvhalf ), mk ); }
-
-static double beta_m_NaTs  ( const double v ) {
-  const double mbetaF  = 0.124;
-  const double mvhalf  = -40.0; // (mV)
-  const double mk      = 6.0; // (mV)
-  return mbetaF * vtrap ( ( v - mvhalf ), mk ); }
-
-static double alpha_h_NaTs ( const double v ) {
-  const double halphaF = 0.015;
-  const double hvhalf = -66.0; // (mV)
-  const double hk = 6.0; // (mV)
-  return halphaF * vtrap ( ( v - hvhalf ), hk ); }
-
-static double beta_h_NaTs  ( const double v ) {
-  const double hbetaF = 0.015;
-  const double hvhalf = -66.0; // (mV)
-  const double hk = 6.0; // (mV)
-  return hbetaF * vtrap ( - ( v - hvhalf ), hk ); }
-
-static double inf_m_NaTs   ( const double v ) { return alpha_m_NaTs(v) / (alpha_m_NaTs(v) + beta_m_NaTs(v)); }
-static double inf_h_NaTs   ( const double v ) { return alpha_h_NaTs(v) / (alpha_h_NaTs(v) + beta_h_NaTs(v)); }
-static double tau_m_NaTs   ( const double v ) {
-  const double celsius = 34.0;
-  const double qt = pow(2.3, (celsius-23.0)/10.0);
-  return (1.0 / (alpha_m_NaTs(v) + beta_m_NaTs(v))) / qt; }
-
-static double tau_h_NaTs   ( const double v ) {
-  const double celsius = 34.0;
-  const double qt = pow(2.3, (celsius-23.0)/10.0);
-  return (1.0 / (alpha_h_NaTs(v) + beta_h_NaTs(v))) / qt; }
-
-
-static double alpha_m_NaTa ( const double v ){
-  const double malphaF = 0.182;
-  const double mvhalf = -48.0;
-  const double mk = 6.0;
-  return malphaF * vtrap(-(v - mvhalf), mk);
-}
-
-static double beta_m_NaTa ( const double v ){
-  const double mbetaF= 0.124;
-  const double mvhalf = -48.0;
-  const double mk = 6.0;
-  return mbetaF * vtrap((v - mvhalf), mk);
-}
-
-static double alpha_h_NaTa ( const double v ){
-  const double halphaF = 0.015;
-  const double hvhalf = -69.0;
-  const double hk     = 6.0;
-  return halphaF * vtrap(v - hvhalf, hk);
-}
-
-static double beta_h_NaTa ( const double v ){
-  const double hbetaF = 0.015;
-  const double hvhalf = -69.0;
-  const double hk     = 6.0;
-  return hbetaF * vtrap(-(v - hvhalf), hk);
-}
-
-static double inf_m_NaTa ( const double v ){
-  return alpha_m_NaTa(v) / (alpha_m_NaTa(v) + beta_m_NaTa(v));
-}
-
-static double inf_h_NaTa ( const double v ){
-  return alpha_h_NaTa(v) / (alpha_h_NaTa(v) + beta_h_NaTa(v));
-}
-
-static double tau_m_NaTa ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 23.0 ) / 10.0 );
-  return (1.0 / (alpha_m_NaTa(v) + beta_m_NaTa(v))) / qt;
-}
-
-static double tau_h_NaTa ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 23.0 ) / 10.0 );
-  return (1.0 / (alpha_h_NaTa(v) + beta_h_NaTa(v)))/ qt;
-}
-
-
-static double alpha_h_Nap ( const double v ){
-  return 2.88e-6 * vtrap(v + 17.0, 4.63);
-  //return 2.88e-3 * vtrap(v + 17.0, 4.63);
-}
-
-static double beta_h_Nap ( const double v ){
-  return 6.94e-6 * vtrap(-(v + 64.4), 2.63);
-  //return 6.94e-3 * vtrap(-(v + 64.4), 2.63);
-}
-
-extern double inf_m_Nap ( const double v ){
-  return 1.0/(1.0+exp((v- (-52.6))/-4.6));
-}
-
-static double inf_h_Nap ( const double v ){
-  return 1.0/(1.0+exp((v- (-48.8))/10.0));
-}
-
-static double tau_h_Nap ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3 , (celcius - 21.0)/10.0 );
-  return (1.0 / (alpha_h_Nap(v) + beta_h_Nap(v))) / qt;
-}
-
-static double alpha_m_Kv2 ( const double v ){
-  return 0.12 * vtrap( -(v - 43.0), 11.0);
-}
-
-static double beta_m_Kv2 ( const double v ){
-  return 0.02 * exp(-(v + 1.27) / 120.0);
-}
-
-static double inf_m_Kv2 ( const double v ){
-  return alpha_m_Kv2(v) / (alpha_m_Kv2(v) + beta_m_Kv2(v));
-}
-
-static double inf_h_Kv2 ( const double v ){
-  return 1.0/(1.0 + exp((v + 58.0) / 11.0));
-}
-
-static double tau_m_Kv2 ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 21.0) / 10.0);
-  return 2.5 * (1.0 / (qt * (alpha_m_Kv2(v) + beta_m_Kv2(v))));
-}
-
-static double tau_h1_Kv2 ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 21.0) / 10.0 );
-  return (360 + (1010 + 23.7 * (v + 54)) * exp(-((v + 75) / 48) *((v + 75) / 48))) / qt;
-}
-
-static double tau_h2_Kv2 ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 21.0) / 10.0 );
-  return (2350 + 1380 * exp(-0.011 * v) - 210 * exp(-0.03 * v)) / qt;
-}
-
-static double inf_m_Kv3 ( const double v ){
-  const double vshift = 0.0;
-  return  1.0/(1.0+exp(((v -(18.700 + vshift))/(-9.700))));
-}
-
-static double tau_m_Kv3 ( const double v ){
-  const double vshift = 0.0;
-  return 0.2 * 20.000 / (1+exp(((v -(-46.560 + vshift))/(-44.140))));
-}
-
-
-static double inf_m_KP ( const double v ){
-  const double vshift = 0.0;
-  return 1.0 / (1.0 + exp(-(v - (-14.3 + vshift)) / 14.6));
-}
-
-static double inf_h_KP ( const double v ) {
-  const double vshift = 0.0; //-1.1;
-  return 1.0/(1.0 + exp(-(v - (-54.0 + vshift))/-11.0));
-}
-
-static double tau_m_KP ( const double v ){
-
-  const double vshift = 0.0;
-  const double tauF = 1.0;
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 21.0)/ 10.0 ); 
-    if (v < -50.0 + vshift){
-      return tauF * (1.25+175.03*exp(-(v - vshift) * -0.026))/qt;
-    } else {
-      return tauF * (1.25+13*exp(-(v - vshift) * 0.026))/qt;
-    }
-}
-
-static double tau_h_KP ( const double v ){
-  const double vshift = 0.0;
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 21.0 )/ 10.0 );
-  return (360.0+(1010.0+24.0*(v - (-55.0 + vshift)))*exp(-((v - (-75.0 + vshift))/48)*((v - (-75.0 + vshift))/48.0)))/qt;
-}
-
-static double inf_m_KT ( const double v ){
-  const double vshift = 0.0;
-  return 1.0/(1.0 + exp(-(v - (-47 + vshift)) / 29.0));
-}
-
-static double inf_h_KT ( const double v ){
-  const double vshift = 0.0;
-  return 1.0/(1.0 + exp(-(v + 66.0 - vshift) / -10.0));
-}
-
-static double tau_m_KT ( const double v ){
-  double mTauF = 1.0;
-  double vshift = 0.0;
-  double celcius = 34.0;
-  double qt = pow ( 2.3, (celcius - 21.0)/10.0);
-  return (0.34 + mTauF * 0.92 * exp(- ((v + 71.0 - vshift) / 59.0) * ((v + 71.0 - vshift) / 59.0))) / qt;
-}
-
-static double tau_h_KT ( const double v ){
-  double hTauF = 1.0;
-  double vshift = 0.0;
-  double celcius = 34.0;
-  double qt = pow ( 2.3, (celcius - 21.0) / 10.0 );
-  return (8.0 + hTauF * 49.0 * exp(- ((v + 73.0 - vshift) / 23.0) * ((v + 73.0 - vshift) / 23.0 ))) / qt;
-}
-
-static double inf_m_Kd ( const double v ){
-  return 1.0 - 1.0 / (1.0 + exp((v - (-43.0)) / 8.0));
-}
-
-static double inf_h_Kd ( const double v ){
-  return 1.0 / (1.0 + exp((v - (-67.0)) / 7.3));
-}
-
-static double tau_m_Kd ( const double v ){
-  return 1.0;
-}
-
-static double tau_h_Kd ( const double v ){
-  return 1500.0;
-}
-
-
-static double alpha_m_Im ( const double v ){
-  return 3.3e-3*exp(2.5*0.04*(v - (-35.0)));
-}
-
-static double beta_m_Im ( const double v ){
-  return 3.3e-3*exp(-2.5*0.04*(v - (-35.0)));
-}
-
-static double inf_m_Im ( const double v ){
-  return alpha_m_Im(v)/(alpha_m_Im(v)+beta_m_Im(v));
-}
-
-static double tau_m_Im ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius - 21.0)/10.0 );
-  return (1.0/(alpha_m_Im(v)+beta_m_Im(v)))/qt;
-}
-
-
-static double alpha_m_Imv2 ( const double v ){
-  return 0.007 * exp( (6.0 * 0.4 * (v - (-48.0))) / 26.12 );
-}
-
-static double beta_m_Imv2 ( const double v ){
-  return 0.007 * exp( (-6.0 * (1.0 - 0.4) * (v - (-48.0))) / 26.12 );
-}
-
-static double inf_m_Imv2 ( const double v ){
-  return alpha_m_Imv2(v) / (alpha_m_Imv2(v) + beta_m_Imv2(v));
-}
-
-static double tau_m_Imv2 ( const double v ){
-  const double celcius = 34.0;
-  const double qt = pow (2.3, (celcius-30.0) / 10.0 );
-  return  (15.0 + 1.0 / (alpha_m_Imv2(v) + beta_m_Imv2(v))) / qt;
-}
-
-static double alpha_m_Ih ( const double v ){
-  return 0.001 * 6.43 * vtrap(v + 154.9, 11.9);
-  //return 6.43 * vtrap(v + 154.9, 11.9);
-}
-
-static double beta_m_Ih ( const double v ){
-  return 0.001 * 193.0 * exp( v /33.1);
-  //return 193.0 * exp( v /33.1);
-}
-
-static double inf_m_Ih ( const double v ){
-  return alpha_m_Ih(v) / (alpha_m_Ih(v) + beta_m_Ih(v));
-}
-
-static double tau_m_Ih ( const double v ){
-  return 1.0 / (alpha_m_Ih(v) + beta_m_Ih(v) );
-}
-
-
-static double inf_z_SK ( const double v, double ca ){
-  if(ca < 1e-7){
-    ca = ca + 1e-07;
-  }
-  return 1.0 / (1.0 + pow ((0.00043 / ca), 4.8));
-}
-
-static double tau_z_SK ( const double v ){
-  return 1.0;
-}
-
-
-static double alpha_m_CaHVA ( const double v ){
-  return 0.055 * vtrap(-27.0 - v, 3.8);
-}
-static double beta_m_CaHVA ( const double v ){
-  return (0.94 * exp((-75.0 - v) / 17.0));
-}
-static double inf_m_CaHVA ( const double v ){
-  return alpha_m_CaHVA(v) / (alpha_m_CaHVA(v) + beta_m_CaHVA(v));
-}
-static double tau_m_CaHVA ( const double v ){
-  return 1.0 / (alpha_m_CaHVA(v) + beta_m_CaHVA (v));
-}
-
-static double alpha_h_CaHVA ( const double v ){
-  return (0.000457 * exp((-13.0 - v) / 50.0));
-}
-static double beta_h_CaHVA ( const double v ){
-  return (0.0065 / (exp((-v - 15.0) / 28.0) + 1.0));
-}
-static double inf_h_CaHVA ( const double v ){
-  return alpha_h_CaHVA(v) / (alpha_h_CaHVA(v) + beta_h_CaHVA(v));
-}
-static double tau_h_CaHVA ( const double v ){
-  return 1.0 / (alpha_h_CaHVA(v) + beta_h_CaHVA(v));
-}
-
-
-static double inf_m_CaLVA ( const double v ){
-  const double v_new = v + 10.0;
-  return 1.0 / (1.0+ exp((v_new - (-30.0)) / -6.0));
-}
-
-static double inf_h_CaLVA ( const double v ){
-  const double v_new = v + 10.0;
-  return 1.0 / (1.0+ exp((v_new - (-80.0))/6.4));
-}
-
-static double tau_m_CaLVA ( const double v ){
-  const double v_new = v + 10.0;
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius-21.0) / 10.0 );
-  return (5.0 + 20.0 / (1.0 + exp((v_new - (-25.0)) / 5.0))) / qt;
-}
-
-static double tau_h_CaLVA ( const double v ){
-  const double v_new = v + 10.0;
-  const double celcius = 34.0;
-  const double qt = pow ( 2.3, (celcius-21.0) / 10.0 );
-  return (20.0 + 50.0 / (1.0 + exp((v_new - (-40.0)) / 7.0))) / qt;
-}
+//
+// The Hodgkin-Huxley channels are generated into ion_gen.h from channels.json (make channels)
+//
 
 //
 // Nav
 //
-#define DT_NaV MIN( DT, 0.01 ) // [ms]
-#define TMP_ITER_NaV ( DT / DT_NaV )
-#define ITER_NaV MAX(1, TMP_ITER_NaV)
+#define DT_NaV(dt) MIN( ( dt ), 0.01 ) // [ms]
+#define ITER_NaV(dt) MAX(1, ( dt ) / DT_NaV ( dt ) ) // dt is the time step of the population
 /*
 static void swap_row( int rA, int rB, int n, double A [ ] [ n ], double b [ ] ){ 
   for ( int i = 0; i < n; i++ ) {
@@ -502,7 +158,8 @@ static void Init_Nav_param ( const double l_v, double matrix [ N_STATE_NAV ] [ N
   matrix[11][4]= c5oo;          matrix[11][10] = i6oo;             matrix[11][11] = 0-(ooc5+ooi6);
 }
 
-static void Set_Nav_param ( const double l_v, double matrix [ N_STATE_NAV ] [ N_STATE_NAV ] ) {
+static void Set_Nav_param ( const double l_v, const double dt, double matrix [ N_STATE_NAV ] [ N_STATE_NAV ] ) {
+  const double dt_nav = DT_NaV ( dt );
   double qt   = 0.77889990199; // qt = q10^((celsius-37(degC))/10(degC))=pow(2.3,((34-37))/10) = 0.77889990199      
   double alphaShift =  qt * 400.0   * exp ( l_v /  24.0   ); // alpha   * exp ( v / x1 )
   double betaShift  =  qt * 12.0    * exp ( l_v / -24.0   ); // beta    * exp ( v / x2 ) * qt
@@ -511,43 +168,43 @@ static void Set_Nav_param ( const double l_v, double matrix [ N_STATE_NAV ] [ N_
   double a = 2.51; //pow ( ( Oon  / Con  ), 0.25 );
   double b = 5.32; //pow ( ( Ooff / Coff ), 0.25 );
 
-  double c1c2 = - DT_NaV * 4.0  * alphaShift;
-  double c2c3 = - DT_NaV * 3.0  * alphaShift;
-  double c3c4 = - DT_NaV * 2.0  * alphaShift;
-  double c4c5 = - DT_NaV * 1.0  * alphaShift;
-  double c5oo = - DT_NaV * 1.0  * gammaShift;
-
-  double i1i2 = - DT_NaV * 4.0  * alphaShift * a;
-  double i2i3 = - DT_NaV * 3.0  * alphaShift * a;
-  double i3i4 = - DT_NaV * 2.0  * alphaShift * a;
-  double i4i5 = - DT_NaV * 1.0  * alphaShift * a;
-  double i5i6 = - DT_NaV * 1.0  * gammaShift;
-
-  double c1i1 = - DT_NaV * 0.01 * qt; // Con*qt
-  double c2i2 = - DT_NaV * 0.01 * qt * a; 
-  double c3i3 = - DT_NaV * 0.01 * qt * a * a;
-  double c4i4 = - DT_NaV * 0.01 * qt * a * a * a;
-  double c5i5 = - DT_NaV * 0.01 * qt * a * a * a * a;
-  double ooi6 = - DT_NaV * 8.0  * qt; // Oon  [ 1 / ms ] * qt
-
-  double ooc5 = - DT_NaV * 1.0  * deltaShift;
-  double c5c4 = - DT_NaV * 4.0  * betaShift;
-  double c4c3 = - DT_NaV * 3.0  * betaShift;
-  double c3c2 = - DT_NaV * 2.0  * betaShift;
-  double c2c1 = - DT_NaV * 1.0  * betaShift;
-
-  double i6i5 = - DT_NaV * 1.0 * deltaShift; 
-  double i5i4 = - DT_NaV * 4.0 * betaShift / b;
-  double i4i3 = - DT_NaV * 3.0 * betaShift / b;
-  double i3i2 = - DT_NaV * 2.0 * betaShift / b;
-  double i2i1 = - DT_NaV * 1.0 * betaShift / b;
-
-  double i1c1 = - DT_NaV * 40.0  * qt; // Coff*qt
-  double i2c2 = - DT_NaV * 40.0  * qt / ( b );
-  double i3c3 = - DT_NaV * 40.0  * qt / ( b * b );
-  double i4c4 = - DT_NaV * 40.0  * qt / ( b * b * b );
-  double i5c5 = - DT_NaV * 40.0  * qt / ( b * b * b * b );
-  double i6oo = - DT_NaV * 0.05  * qt; // Ooff [ 1 / ms ] * qt;
+  double c1c2 = - dt_nav * 4.0  * alphaShift;
+  double c2c3 = - dt_nav * 3.0  * alphaShift;
+  double c3c4 = - dt_nav * 2.0  * alphaShift;
+  double c4c5 = - dt_nav * 1.0  * alphaShift;
+  double c5oo = - dt_nav * 1.0  * gammaShift;
+
+  double i1i2 = - dt_nav * 4.0  * alphaShift * a;
+  double i2i3 = - dt_nav * 3.0  * alphaShift * a;
+  double i3i4 = - dt_nav * 2.0  * alphaShift * a;
+  double i4i5 = - dt_nav * 1.0  * alphaShift * a;
+  double i5i6 = - dt_nav * 1.0  * gammaShift;
+
+  double c1i1 = - dt_nav * 0.01 * qt; // Con*qt
+  double c2i2 = - dt_nav * 0.01 * qt * a; 
+  double c3i3 = - dt_nav * 0.01 * qt * a * a;
+  double c4i4 = - dt_nav * 0.01 * qt * a * a * a;
+  double c5i5 = - dt_nav * 0.01 * qt * a * a * a * a;
+  double ooi6 = - dt_nav * 8.0  * qt; // Oon  [ 1 / ms ] * qt
+
+  double ooc5 = - dt_nav * 1.0  * deltaShift;
+  double c5c4 = - dt_nav * 4.0  * betaShift;
+  double c4c3 = - dt_nav * 3.0  * betaShift;
+  double c3c2 = - dt_nav * 2.0  * betaShift;
+  double c2c1 = - dt_nav * 1.0  * betaShift;
+
+  double i6i5 = - dt_nav * 1.0 * deltaShift; 
+  double i5i4 = - dt_nav * 4.0 * betaShift / b;
+  double i4i3 = - dt_nav * 3.0 * betaShift / b;
+  double i3i2 = - dt_nav * 2.0 * betaShift / b;
+  double i2i1 = - dt_nav * 1.0 * betaShift / b;
+
+  double i1c1 = - dt_nav * 40.0  * qt; // Coff*qt
+  double i2c2 = - dt_nav * 40.0  * qt / ( b );
+  double i3c3 = - dt_nav * 40.0  * qt / ( b * b );
+  double i4c4 = - dt_nav * 40.0  * qt / ( b * b * b );
+  double i5c5 = - dt_nav * 40.0  * qt / ( b * b * b * b );
+  double i6oo = - dt_nav * 0.05  * qt; // Ooff [ 1 / ms ] * qt;
 
   //                  c1,                c2,                c3,                c4,                c5,                i1,                i2,                i3,                i4,               i5,               i6,                 oo
   double l_mat [ N_STATE_NAV ] [ N_STATE_NAV ] = {
@@ -573,14 +230,14 @@ static void Set_Nav_param ( const double l_v, double matrix [ N_STATE_NAV ] [ N_
 
 
 // First order
-static void Nav_update ( const double l_v, double *oo, double *c1, double *c2, double *c3, double *c4, double *c5, double *i1, double *i2, double *i3, double *i4, double *i5, double *i6 ) {
+static void Nav_update ( const double l_v, const double dt, double *oo, double *c1, double *c2, double *c3, double *c4, double *c5, double *i1, double *i2, double *i3, double *i4, double *i5, double *i6 ) {
   
   double vca [ N_STATE_NAV ] [ N_STATE_NAV ] = {};
   double vcb [ N_STATE_NAV ] = { c1 [ 0 ] , c2 [ 0 ], c3 [ 0 ], c4 [ 0 ], c5 [ 0 ], i1 [ 0 ], i2 [ 0 ], i3 [ 0 ], i4 [ 0 ], i5 [ 0 ], i6 [ 0 ], oo [ 0 ] };  
   double matrixA [ N_STATE_NAV ] [ N_STATE_NAV ] = {};
   //GR Na channel parameters
-  Set_Nav_param ( l_v, matrixA );
-  for ( int iter = 0; iter < ( int ) ITER_NaV; iter++ ) {
+  Set_Nav_param ( l_v, dt, matrixA );
+  for ( int iter = 0; iter < ( int ) ITER_NaV ( dt ); iter++ ) {
     for ( int i = 0; i < N_STATE_NAV; i++ ) { 
       for ( int j = 0; j < N_STATE_NAV; j++ ) { 
         vca [ i ] [ j ] = matrixA [ i ] [ j ]; 
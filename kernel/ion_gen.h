@@ -0,0 +1,1167 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+// Generated by helper/gen_channels.py from channels.json (make channels); do not edit.
+
+#pragma once
+
+#include <math.h>
+#include "ion.h"
+#include "precision.h"
+#include "config.h"
+
+#ifdef _OPENMP
+#define OMP_SIMD _Pragma ( "omp simd" )
+#else
+#define OMP_SIMD // without OpenMP the loops are left to the auto-vectorizer
+#endif
+
+//
+// Lookup tables (ION_LUT == 1): ION_LUT_N rows of inf and tau of all gates of a channel, evenly spaced
+// over the range, interpolated linearly and clamped to the range. Channels that depend on ca are always computed.
+//
+#define ION_LUT_V_MIN ( -150.0 ) // [mV]
+#define ION_LUT_V_MAX ( 100.0 ) // [mV]
+#define ION_LUT_DV ( ( ION_LUT_V_MAX - ION_LUT_V_MIN ) / ( ION_LUT_N - 1 ) ) // [mV]
+
+static inline void lut_interpolate ( const double *lut, const int n_gate, const double v, double * __restrict__ inf, double * __restrict__ tau )
+{
+  double x = ( v - ION_LUT_V_MIN ) / ION_LUT_DV;
+  x = ( x < 0.0 ) ? 0.0 : ( x > ION_LUT_N - 1 ) ? ION_LUT_N - 1 : x;
+  const int k = ( x < ION_LUT_N - 1 ) ? ( int ) x : ION_LUT_N - 2;
+  const double f = x - k;
+  const double *r0 = &lut [ 2 * n_gate * k ], *r1 = r0 + 2 * n_gate;
+  for ( int j = 0; j < n_gate; j++ ) {
+    inf [ j ] = r0 [ j ] + f * ( r1 [ j ] - r0 [ j ] );
+    tau [ j ] = r0 [ n_gate + j ] + f * ( r1 [ n_gate + j ] - r0 [ n_gate + j ] );
+  }
+}
+
+//
+// NaTs: m_NaTs, h_NaTs
+//
+#define N_GATE_NaTs ( 2 )
+#if ION_LUT == 1
+static double lut_NaTs [ ION_LUT_N * 2 * N_GATE_NaTs ];
+#endif
+
+static inline void rate_NaTs_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v - ( -40.0 ) );
+  const double _t1 = vtrap ( - _t0, 6.0 );
+  const double _t2 = ( 0.182 * _t1 );
+  const double _t3 = vtrap ( _t0, 6.0 );
+  const double _t4 = ( 0.124 * _t3 );
+  const double _t5 = ( _t2 + _t4 );
+  const double _t6 = ( v - ( -66.0 ) );
+  const double _t7 = vtrap ( _t6, 6.0 );
+  const double _t8 = ( 0.015 * _t7 );
+  const double _t9 = vtrap ( - _t6, 6.0 );
+  const double _t10 = ( 0.015 * _t9 );
+  const double _t11 = ( _t8 + _t10 );
+  inf [ 0 ] = ( _t2 / _t5 ); // m_NaTs
+  tau [ 0 ] = ( ( 1.0 / _t5 ) / 2.4997732686681893 );
+  inf [ 1 ] = ( _t8 / _t11 ); // h_NaTs
+  tau [ 1 ] = ( ( 1.0 / _t11 ) / 2.4997732686681893 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_NaTs ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_NaTs, N_GATE_NaTs, v, inf, tau );
+#else
+  rate_NaTs_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_NaTs_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_NaTs ], _tau [ N_GATE_NaTs ];
+    rate_NaTs ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_NaTs; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_NaTs ( const double v )
+{
+  const double _t0 = ( v - ( -40.0 ) );
+  const double _t1 = vtrap ( - _t0, 6.0 );
+  const double _t2 = ( 0.182 * _t1 );
+  return ( _t2 / ( _t2 + ( 0.124 * vtrap ( _t0, 6.0 ) ) ) );
+}
+
+static inline double tau_m_NaTs ( const double v )
+{
+  const double _t0 = ( v - ( -40.0 ) );
+  return ( ( 1.0 / ( ( 0.182 * vtrap ( - _t0, 6.0 ) ) + ( 0.124 * vtrap ( _t0, 6.0 ) ) ) ) / 2.4997732686681893 );
+}
+
+static inline double inf_h_NaTs ( const double v )
+{
+  const double _t0 = ( v - ( -66.0 ) );
+  const double _t1 = vtrap ( _t0, 6.0 );
+  const double _t2 = ( 0.015 * _t1 );
+  return ( _t2 / ( _t2 + ( 0.015 * vtrap ( - _t0, 6.0 ) ) ) );
+}
+
+static inline double tau_h_NaTs ( const double v )
+{
+  const double _t0 = ( v - ( -66.0 ) );
+  return ( ( 1.0 / ( ( 0.015 * vtrap ( _t0, 6.0 ) ) + ( 0.015 * vtrap ( - _t0, 6.0 ) ) ) ) / 2.4997732686681893 );
+}
+
+//
+// NaTa: m_NaTa, h_NaTa
+//
+#define N_GATE_NaTa ( 2 )
+#if ION_LUT == 1
+static double lut_NaTa [ ION_LUT_N * 2 * N_GATE_NaTa ];
+#endif
+
+static inline void rate_NaTa_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v - ( -48.0 ) );
+  const double _t1 = vtrap ( - _t0, 6.0 );
+  const double _t2 = ( 0.182 * _t1 );
+  const double _t3 = vtrap ( _t0, 6.0 );
+  const double _t4 = ( 0.124 * _t3 );
+  const double _t5 = ( _t2 + _t4 );
+  const double _t6 = ( v - ( -69.0 ) );
+  const double _t7 = vtrap ( _t6, 6.0 );
+  const double _t8 = ( 0.015 * _t7 );
+  const double _t9 = vtrap ( - _t6, 6.0 );
+  const double _t10 = ( 0.015 * _t9 );
+  const double _t11 = ( _t8 + _t10 );
+  inf [ 0 ] = ( _t2 / _t5 ); // m_NaTa
+  tau [ 0 ] = ( ( 1.0 / _t5 ) / 2.4997732686681893 );
+  inf [ 1 ] = ( _t8 / _t11 ); // h_NaTa
+  tau [ 1 ] = ( ( 1.0 / _t11 ) / 2.4997732686681893 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_NaTa ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_NaTa, N_GATE_NaTa, v, inf, tau );
+#else
+  rate_NaTa_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_NaTa_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_NaTa ], _tau [ N_GATE_NaTa ];
+    rate_NaTa ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_NaTa; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_NaTa ( const double v )
+{
+  const double _t0 = ( v - ( -48.0 ) );
+  const double _t1 = vtrap ( - _t0, 6.0 );
+  const double _t2 = ( 0.182 * _t1 );
+  return ( _t2 / ( _t2 + ( 0.124 * vtrap ( _t0, 6.0 ) ) ) );
+}
+
+static inline double tau_m_NaTa ( const double v )
+{
+  const double _t0 = ( v - ( -48.0 ) );
+  return ( ( 1.0 / ( ( 0.182 * vtrap ( - _t0, 6.0 ) ) + ( 0.124 * vtrap ( _t0, 6.0 ) ) ) ) / 2.4997732686681893 );
+}
+
+static inline double inf_h_NaTa ( const double v )
+{
+  const double _t0 = ( v - ( -69.0 ) );
+  const double _t1 = vtrap ( _t0, 6.0 );
+  const double _t2 = ( 0.015 * _t1 );
+  return ( _t2 / ( _t2 + ( 0.015 * vtrap ( - _t0, 6.0 ) ) ) );
+}
+
+static inline double tau_h_NaTa ( const double v )
+{
+  const double _t0 = ( v - ( -69.0 ) );
+  return ( ( 1.0 / ( ( 0.015 * vtrap ( _t0, 6.0 ) ) + ( 0.015 * vtrap ( - _t0, 6.0 ) ) ) ) / 2.4997732686681893 );
+}
+
+//
+// Nap: m_Nap, h_Nap
+//
+#define N_GATE_Nap ( 1 )
+#if ION_LUT == 1
+static double lut_Nap [ ION_LUT_N * 2 * N_GATE_Nap ];
+#endif
+
+static inline void rate_Nap_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  inf [ 0 ] = ( 1.0 / ( 1.0 + exp ( ( ( v - ( -48.8 ) ) / 10.0 ) ) ) ); // h_Nap
+  tau [ 0 ] = ( ( 1.0 / ( ( 2.88e-06 * vtrap ( ( v + 17.0 ), 4.63 ) ) + ( 6.94e-06 * vtrap ( - ( v + 64.4 ), 2.63 ) ) ) ) / 2.952882641412121 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_Nap ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_Nap, N_GATE_Nap, v, inf, tau );
+#else
+  rate_Nap_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_Nap_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_Nap ], _tau [ N_GATE_Nap ];
+    rate_Nap ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_Nap; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_Nap ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( v - ( -52.6 ) ) / ( -4.6 ) ) ) ) );
+}
+
+static inline double inf_h_Nap ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( v - ( -48.8 ) ) / 10.0 ) ) ) );
+}
+
+static inline double tau_h_Nap ( const double v )
+{
+  return ( ( 1.0 / ( ( 2.88e-06 * vtrap ( ( v + 17.0 ), 4.63 ) ) + ( 6.94e-06 * vtrap ( - ( v + 64.4 ), 2.63 ) ) ) ) / 2.952882641412121 );
+}
+
+//
+// Kv2: m_Kv2, h1_Kv2, h2_Kv2
+//
+#define N_GATE_Kv2 ( 3 )
+#if ION_LUT == 1
+static double lut_Kv2 [ ION_LUT_N * 2 * N_GATE_Kv2 ];
+#endif
+
+static inline void rate_Kv2_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v - 43.0 );
+  const double _t1 = vtrap ( - _t0, 11.0 );
+  const double _t2 = ( 0.12 * _t1 );
+  const double _t3 = ( v + 1.27 );
+  const double _t4 = ( - _t3 / 120.0 );
+  const double _t5 = exp ( _t4 );
+  const double _t6 = ( 0.02 * _t5 );
+  const double _t7 = ( _t2 + _t6 );
+  const double _t8 = ( v + 58.0 );
+  const double _t9 = ( _t8 / 11.0 );
+  const double _t10 = exp ( _t9 );
+  const double _t11 = ( 1.0 + _t10 );
+  const double _t12 = ( 1.0 / _t11 );
+  const double _t13 = ( v + 75.0 );
+  const double _t14 = ( _t13 / 48.0 );
+  inf [ 0 ] = ( _t2 / _t7 ); // m_Kv2
+  tau [ 0 ] = ( 2.5 * ( 1.0 / ( 2.952882641412121 * _t7 ) ) );
+  inf [ 1 ] = _t12; // h1_Kv2
+  tau [ 1 ] = ( ( 360.0 + ( ( 1010.0 + ( 23.7 * ( v + 54.0 ) ) ) * exp ( ( - _t14 * _t14 ) ) ) ) / 2.952882641412121 );
+  inf [ 2 ] = _t12; // h2_Kv2
+  tau [ 2 ] = ( ( ( 2350.0 + ( 1380.0 * exp ( ( ( -0.011 ) * v ) ) ) ) - ( 210.0 * exp ( ( ( -0.03 ) * v ) ) ) ) / 2.952882641412121 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_Kv2 ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_Kv2, N_GATE_Kv2, v, inf, tau );
+#else
+  rate_Kv2_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_Kv2_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_Kv2 ], _tau [ N_GATE_Kv2 ];
+    rate_Kv2 ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_Kv2; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_Kv2 ( const double v )
+{
+  const double _t0 = ( v - 43.0 );
+  const double _t1 = vtrap ( - _t0, 11.0 );
+  const double _t2 = ( 0.12 * _t1 );
+  return ( _t2 / ( _t2 + ( 0.02 * exp ( ( - ( v + 1.27 ) / 120.0 ) ) ) ) );
+}
+
+static inline double tau_m_Kv2 ( const double v )
+{
+  return ( 2.5 * ( 1.0 / ( 2.952882641412121 * ( ( 0.12 * vtrap ( - ( v - 43.0 ), 11.0 ) ) + ( 0.02 * exp ( ( - ( v + 1.27 ) / 120.0 ) ) ) ) ) ) );
+}
+
+static inline double inf_h1_Kv2 ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( v + 58.0 ) / 11.0 ) ) ) );
+}
+
+static inline double tau_h1_Kv2 ( const double v )
+{
+  const double _t0 = ( v + 75.0 );
+  const double _t1 = ( _t0 / 48.0 );
+  return ( ( 360.0 + ( ( 1010.0 + ( 23.7 * ( v + 54.0 ) ) ) * exp ( ( - _t1 * _t1 ) ) ) ) / 2.952882641412121 );
+}
+
+static inline double inf_h2_Kv2 ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( v + 58.0 ) / 11.0 ) ) ) );
+}
+
+static inline double tau_h2_Kv2 ( const double v )
+{
+  return ( ( ( 2350.0 + ( 1380.0 * exp ( ( ( -0.011 ) * v ) ) ) ) - ( 210.0 * exp ( ( ( -0.03 ) * v ) ) ) ) / 2.952882641412121 );
+}
+
+//
+// Kv3: m_Kv3
+//
+#define N_GATE_Kv3 ( 1 )
+#if ION_LUT == 1
+static double lut_Kv3 [ ION_LUT_N * 2 * N_GATE_Kv3 ];
+#endif
+
+static inline void rate_Kv3_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  inf [ 0 ] = ( 1.0 / ( 1.0 + exp ( ( ( v - 18.7 ) / ( -9.7 ) ) ) ) ); // m_Kv3
+  tau [ 0 ] = ( 4.0 / ( 1.0 + exp ( ( ( v - ( -46.56 ) ) / ( -44.14 ) ) ) ) );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_Kv3 ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_Kv3, N_GATE_Kv3, v, inf, tau );
+#else
+  rate_Kv3_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_Kv3_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_Kv3 ], _tau [ N_GATE_Kv3 ];
+    rate_Kv3 ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_Kv3; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_Kv3 ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( v - 18.7 ) / ( -9.7 ) ) ) ) );
+}
+
+static inline double tau_m_Kv3 ( const double v )
+{
+  return ( 4.0 / ( 1.0 + exp ( ( ( v - ( -46.56 ) ) / ( -44.14 ) ) ) ) );
+}
+
+//
+// KP: m_KP, h_KP
+//
+#define N_GATE_KP ( 2 )
+#if ION_LUT == 1
+static double lut_KP [ ION_LUT_N * 2 * N_GATE_KP ];
+#endif
+
+static inline void rate_KP_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v - ( -75.0 ) );
+  const double _t1 = ( _t0 / 48.0 );
+  inf [ 0 ] = ( 1.0 / ( 1.0 + exp ( ( - ( v - ( -14.3 ) ) / 14.6 ) ) ) ); // m_KP
+  tau [ 0 ] = ( ( v < ( -50.0 ) ) ? ( ( 1.0 * ( 1.25 + ( 175.03 * exp ( ( - v * ( -0.026 ) ) ) ) ) ) / 2.952882641412121 ) : ( ( 1.0 * ( 1.25 + ( 13.0 * exp ( ( - v * 0.026 ) ) ) ) ) / 2.952882641412121 ) );
+  inf [ 1 ] = ( 1.0 / ( 1.0 + exp ( ( - ( v - ( -54.0 ) ) / ( -11.0 ) ) ) ) ); // h_KP
+  tau [ 1 ] = ( ( 360.0 + ( ( 1010.0 + ( 24.0 * ( v - ( -55.0 ) ) ) ) * exp ( ( - _t1 * _t1 ) ) ) ) / 2.952882641412121 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_KP ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_KP, N_GATE_KP, v, inf, tau );
+#else
+  rate_KP_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_KP_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_KP ], _tau [ N_GATE_KP ];
+    rate_KP ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_KP; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_KP ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( - ( v - ( -14.3 ) ) / 14.6 ) ) ) );
+}
+
+static inline double tau_m_KP ( const double v )
+{
+  return ( ( v < ( -50.0 ) ) ? ( ( 1.0 * ( 1.25 + ( 175.03 * exp ( ( - v * ( -0.026 ) ) ) ) ) ) / 2.952882641412121 ) : ( ( 1.0 * ( 1.25 + ( 13.0 * exp ( ( - v * 0.026 ) ) ) ) ) / 2.952882641412121 ) );
+}
+
+static inline double inf_h_KP ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( - ( v - ( -54.0 ) ) / ( -11.0 ) ) ) ) );
+}
+
+static inline double tau_h_KP ( const double v )
+{
+  const double _t0 = ( v - ( -75.0 ) );
+  const double _t1 = ( _t0 / 48.0 );
+  return ( ( 360.0 + ( ( 1010.0 + ( 24.0 * ( v - ( -55.0 ) ) ) ) * exp ( ( - _t1 * _t1 ) ) ) ) / 2.952882641412121 );
+}
+
+//
+// KT: m_KT, h_KT
+//
+#define N_GATE_KT ( 2 )
+#if ION_LUT == 1
+static double lut_KT [ ION_LUT_N * 2 * N_GATE_KT ];
+#endif
+
+static inline void rate_KT_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v + 71.0 );
+  const double _t1 = ( _t0 / 59.0 );
+  const double _t2 = ( v + 73.0 );
+  const double _t3 = ( _t2 / 23.0 );
+  inf [ 0 ] = ( 1.0 / ( 1.0 + exp ( ( - ( v - ( -47.0 ) ) / 29.0 ) ) ) ); // m_KT
+  tau [ 0 ] = ( ( 0.34 + ( 0.92 * exp ( ( - _t1 * _t1 ) ) ) ) / 2.952882641412121 );
+  inf [ 1 ] = ( 1.0 / ( 1.0 + exp ( ( - ( v + 66.0 ) / ( -10.0 ) ) ) ) ); // h_KT
+  tau [ 1 ] = ( ( 8.0 + ( 49.0 * exp ( ( - _t3 * _t3 ) ) ) ) / 2.952882641412121 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_KT ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_KT, N_GATE_KT, v, inf, tau );
+#else
+  rate_KT_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_KT_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_KT ], _tau [ N_GATE_KT ];
+    rate_KT ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_KT; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_KT ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( - ( v - ( -47.0 ) ) / 29.0 ) ) ) );
+}
+
+static inline double tau_m_KT ( const double v )
+{
+  const double _t0 = ( v + 71.0 );
+  const double _t1 = ( _t0 / 59.0 );
+  return ( ( 0.34 + ( 0.92 * exp ( ( - _t1 * _t1 ) ) ) ) / 2.952882641412121 );
+}
+
+static inline double inf_h_KT ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( - ( v + 66.0 ) / ( -10.0 ) ) ) ) );
+}
+
+static inline double tau_h_KT ( const double v )
+{
+  const double _t0 = ( v + 73.0 );
+  const double _t1 = ( _t0 / 23.0 );
+  return ( ( 8.0 + ( 49.0 * exp ( ( - _t1 * _t1 ) ) ) ) / 2.952882641412121 );
+}
+
+//
+// Kd: m_Kd, h_Kd
+//
+#define N_GATE_Kd ( 2 )
+#if ION_LUT == 1
+static double lut_Kd [ ION_LUT_N * 2 * N_GATE_Kd ];
+#endif
+
+static inline void rate_Kd_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  inf [ 0 ] = ( 1.0 - ( 1.0 / ( 1.0 + exp ( ( ( v - ( -43.0 ) ) / 8.0 ) ) ) ) ); // m_Kd
+  tau [ 0 ] = 1.0;
+  inf [ 1 ] = ( 1.0 / ( 1.0 + exp ( ( ( v - ( -67.0 ) ) / 7.3 ) ) ) ); // h_Kd
+  tau [ 1 ] = 1500.0;
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_Kd ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_Kd, N_GATE_Kd, v, inf, tau );
+#else
+  rate_Kd_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_Kd_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_Kd ], _tau [ N_GATE_Kd ];
+    rate_Kd ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_Kd; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_Kd ( const double v )
+{
+  return ( 1.0 - ( 1.0 / ( 1.0 + exp ( ( ( v - ( -43.0 ) ) / 8.0 ) ) ) ) );
+}
+
+static inline double tau_m_Kd ( const double v )
+{
+  return 1.0;
+}
+
+static inline double inf_h_Kd ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( v - ( -67.0 ) ) / 7.3 ) ) ) );
+}
+
+static inline double tau_h_Kd ( const double v )
+{
+  return 1500.0;
+}
+
+//
+// Im: m_Im
+//
+#define N_GATE_Im ( 1 )
+#if ION_LUT == 1
+static double lut_Im [ ION_LUT_N * 2 * N_GATE_Im ];
+#endif
+
+static inline void rate_Im_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v - ( -35.0 ) );
+  const double _t1 = ( 0.1 * _t0 );
+  const double _t2 = exp ( _t1 );
+  const double _t3 = ( 0.0033 * _t2 );
+  const double _t4 = ( ( -0.1 ) * _t0 );
+  const double _t5 = exp ( _t4 );
+  const double _t6 = ( 0.0033 * _t5 );
+  const double _t7 = ( _t3 + _t6 );
+  inf [ 0 ] = ( _t3 / _t7 ); // m_Im
+  tau [ 0 ] = ( ( 1.0 / _t7 ) / 2.952882641412121 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_Im ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_Im, N_GATE_Im, v, inf, tau );
+#else
+  rate_Im_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_Im_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_Im ], _tau [ N_GATE_Im ];
+    rate_Im ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_Im; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_Im ( const double v )
+{
+  const double _t0 = ( v - ( -35.0 ) );
+  const double _t1 = ( 0.1 * _t0 );
+  const double _t2 = exp ( _t1 );
+  const double _t3 = ( 0.0033 * _t2 );
+  return ( _t3 / ( _t3 + ( 0.0033 * exp ( ( ( -0.1 ) * _t0 ) ) ) ) );
+}
+
+static inline double tau_m_Im ( const double v )
+{
+  const double _t0 = ( v - ( -35.0 ) );
+  return ( ( 1.0 / ( ( 0.0033 * exp ( ( 0.1 * _t0 ) ) ) + ( 0.0033 * exp ( ( ( -0.1 ) * _t0 ) ) ) ) ) / 2.952882641412121 );
+}
+
+//
+// Imv2: m_Imv2
+//
+#define N_GATE_Imv2 ( 1 )
+#if ION_LUT == 1
+static double lut_Imv2 [ ION_LUT_N * 2 * N_GATE_Imv2 ];
+#endif
+
+static inline void rate_Imv2_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v - ( -48.0 ) );
+  const double _t1 = ( 2.4000000000000004 * _t0 );
+  const double _t2 = ( _t1 / 26.12 );
+  const double _t3 = exp ( _t2 );
+  const double _t4 = ( 0.007 * _t3 );
+  const double _t5 = ( ( -3.5999999999999996 ) * _t0 );
+  const double _t6 = ( _t5 / 26.12 );
+  const double _t7 = exp ( _t6 );
+  const double _t8 = ( 0.007 * _t7 );
+  const double _t9 = ( _t4 + _t8 );
+  inf [ 0 ] = ( _t4 / _t9 ); // m_Imv2
+  tau [ 0 ] = ( ( 15.0 + ( 1.0 / _t9 ) ) / 1.39537563185564 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_Imv2 ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_Imv2, N_GATE_Imv2, v, inf, tau );
+#else
+  rate_Imv2_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_Imv2_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_Imv2 ], _tau [ N_GATE_Imv2 ];
+    rate_Imv2 ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_Imv2; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_Imv2 ( const double v )
+{
+  const double _t0 = ( v - ( -48.0 ) );
+  const double _t1 = ( 2.4000000000000004 * _t0 );
+  const double _t2 = ( _t1 / 26.12 );
+  const double _t3 = exp ( _t2 );
+  const double _t4 = ( 0.007 * _t3 );
+  return ( _t4 / ( _t4 + ( 0.007 * exp ( ( ( ( -3.5999999999999996 ) * _t0 ) / 26.12 ) ) ) ) );
+}
+
+static inline double tau_m_Imv2 ( const double v )
+{
+  const double _t0 = ( v - ( -48.0 ) );
+  return ( ( 15.0 + ( 1.0 / ( ( 0.007 * exp ( ( ( 2.4000000000000004 * _t0 ) / 26.12 ) ) ) + ( 0.007 * exp ( ( ( ( -3.5999999999999996 ) * _t0 ) / 26.12 ) ) ) ) ) ) / 1.39537563185564 );
+}
+
+//
+// Ih: m_Ih
+//
+#define N_GATE_Ih ( 1 )
+#if ION_LUT == 1
+static double lut_Ih [ ION_LUT_N * 2 * N_GATE_Ih ];
+#endif
+
+static inline void rate_Ih_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v + 154.9 );
+  const double _t1 = vtrap ( _t0, 11.9 );
+  const double _t2 = ( 0.00643 * _t1 );
+  const double _t3 = ( v / 33.1 );
+  const double _t4 = exp ( _t3 );
+  const double _t5 = ( 0.193 * _t4 );
+  const double _t6 = ( _t2 + _t5 );
+  inf [ 0 ] = ( _t2 / _t6 ); // m_Ih
+  tau [ 0 ] = ( 1.0 / _t6 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_Ih ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_Ih, N_GATE_Ih, v, inf, tau );
+#else
+  rate_Ih_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_Ih_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_Ih ], _tau [ N_GATE_Ih ];
+    rate_Ih ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_Ih; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_Ih ( const double v )
+{
+  const double _t0 = ( v + 154.9 );
+  const double _t1 = vtrap ( _t0, 11.9 );
+  const double _t2 = ( 0.00643 * _t1 );
+  return ( _t2 / ( _t2 + ( 0.193 * exp ( ( v / 33.1 ) ) ) ) );
+}
+
+static inline double tau_m_Ih ( const double v )
+{
+  return ( 1.0 / ( ( 0.00643 * vtrap ( ( v + 154.9 ), 11.9 ) ) + ( 0.193 * exp ( ( v / 33.1 ) ) ) ) );
+}
+
+//
+// SK: z_SK
+//
+#define N_GATE_SK ( 1 )
+
+static inline void rate_SK_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  inf [ 0 ] = ( 1.0 / ( 1.0 + pow ( ( 0.00043 / ( ( ca < 1e-07 ) ? ( ca + 1e-07 ) : ca ) ), 4.8 ) ) ); // z_SK
+  tau [ 0 ] = 1.0;
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_SK ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  rate_SK_exact ( v, ca, inf, tau );
+}
+
+static inline void rate_SK_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_SK ], _tau [ N_GATE_SK ];
+    rate_SK ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_SK; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_z_SK ( const double v, const double ca )
+{
+  return ( 1.0 / ( 1.0 + pow ( ( 0.00043 / ( ( ca < 1e-07 ) ? ( ca + 1e-07 ) : ca ) ), 4.8 ) ) );
+}
+
+static inline double tau_z_SK ( const double v )
+{
+  return 1.0;
+}
+
+//
+// CaHVA: m_CaHVA, h_CaHVA
+//
+#define N_GATE_CaHVA ( 2 )
+#if ION_LUT == 1
+static double lut_CaHVA [ ION_LUT_N * 2 * N_GATE_CaHVA ];
+#endif
+
+static inline void rate_CaHVA_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( ( -27.0 ) - v );
+  const double _t1 = vtrap ( _t0, 3.8 );
+  const double _t2 = ( 0.055 * _t1 );
+  const double _t3 = ( ( -75.0 ) - v );
+  const double _t4 = ( _t3 / 17.0 );
+  const double _t5 = exp ( _t4 );
+  const double _t6 = ( 0.94 * _t5 );
+  const double _t7 = ( _t2 + _t6 );
+  const double _t8 = ( ( -13.0 ) - v );
+  const double _t9 = ( _t8 / 50.0 );
+  const double _t10 = exp ( _t9 );
+  const double _t11 = ( 0.000457 * _t10 );
+  const double _t12 = ( - v - 15.0 );
+  const double _t13 = ( _t12 / 28.0 );
+  const double _t14 = exp ( _t13 );
+  const double _t15 = ( _t14 + 1.0 );
+  const double _t16 = ( 0.0065 / _t15 );
+  const double _t17 = ( _t11 + _t16 );
+  inf [ 0 ] = ( _t2 / _t7 ); // m_CaHVA
+  tau [ 0 ] = ( 1.0 / _t7 );
+  inf [ 1 ] = ( _t11 / _t17 ); // h_CaHVA
+  tau [ 1 ] = ( 1.0 / _t17 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_CaHVA ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_CaHVA, N_GATE_CaHVA, v, inf, tau );
+#else
+  rate_CaHVA_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_CaHVA_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_CaHVA ], _tau [ N_GATE_CaHVA ];
+    rate_CaHVA ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_CaHVA; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_CaHVA ( const double v )
+{
+  const double _t0 = ( ( -27.0 ) - v );
+  const double _t1 = vtrap ( _t0, 3.8 );
+  const double _t2 = ( 0.055 * _t1 );
+  return ( _t2 / ( _t2 + ( 0.94 * exp ( ( ( ( -75.0 ) - v ) / 17.0 ) ) ) ) );
+}
+
+static inline double tau_m_CaHVA ( const double v )
+{
+  return ( 1.0 / ( ( 0.055 * vtrap ( ( ( -27.0 ) - v ), 3.8 ) ) + ( 0.94 * exp ( ( ( ( -75.0 ) - v ) / 17.0 ) ) ) ) );
+}
+
+static inline double inf_h_CaHVA ( const double v )
+{
+  const double _t0 = ( ( -13.0 ) - v );
+  const double _t1 = ( _t0 / 50.0 );
+  const double _t2 = exp ( _t1 );
+  const double _t3 = ( 0.000457 * _t2 );
+  return ( _t3 / ( _t3 + ( 0.0065 / ( exp ( ( ( - v - 15.0 ) / 28.0 ) ) + 1.0 ) ) ) );
+}
+
+static inline double tau_h_CaHVA ( const double v )
+{
+  return ( 1.0 / ( ( 0.000457 * exp ( ( ( ( -13.0 ) - v ) / 50.0 ) ) ) + ( 0.0065 / ( exp ( ( ( - v - 15.0 ) / 28.0 ) ) + 1.0 ) ) ) );
+}
+
+//
+// CaLVA: m_CaLVA, h_CaLVA
+//
+#define N_GATE_CaLVA ( 2 )
+#if ION_LUT == 1
+static double lut_CaLVA [ ION_LUT_N * 2 * N_GATE_CaLVA ];
+#endif
+
+static inline void rate_CaLVA_exact ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+  const double _t0 = ( v + 10.0 );
+  inf [ 0 ] = ( 1.0 / ( 1.0 + exp ( ( ( _t0 - ( -30.0 ) ) / ( -6.0 ) ) ) ) ); // m_CaLVA
+  tau [ 0 ] = ( ( 5.0 + ( 20.0 / ( 1.0 + exp ( ( ( _t0 - ( -25.0 ) ) / 5.0 ) ) ) ) ) / 2.952882641412121 );
+  inf [ 1 ] = ( 1.0 / ( 1.0 + exp ( ( ( _t0 - ( -80.0 ) ) / 6.4 ) ) ) ); // h_CaLVA
+  tau [ 1 ] = ( ( 20.0 + ( 50.0 / ( 1.0 + exp ( ( ( _t0 - ( -40.0 ) ) / 7.0 ) ) ) ) ) / 2.952882641412121 );
+}
+
+static inline __attribute__ ( ( always_inline ) ) void rate_CaLVA ( const double v, const double ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+#if ION_LUT == 1
+  lut_interpolate ( lut_CaLVA, N_GATE_CaLVA, v, inf, tau );
+#else
+  rate_CaLVA_exact ( v, ca, inf, tau );
+#endif
+}
+
+static inline void rate_CaLVA_batch ( const int n, const double * __restrict__ v, const double * __restrict__ ca, double * __restrict__ inf, double * __restrict__ tau )
+{
+OMP_SIMD
+  for ( int k = 0; k < n; k++ ) {
+    double _inf [ N_GATE_CaLVA ], _tau [ N_GATE_CaLVA ];
+    rate_CaLVA ( v [ k ], ca [ k ], _inf, _tau );
+    for ( int j = 0; j < N_GATE_CaLVA; j++ ) { inf [ k + n * j ] = _inf [ j ]; tau [ k + n * j ] = _tau [ j ]; }
+  }
+}
+
+static inline double inf_m_CaLVA ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( ( v + 10.0 ) - ( -30.0 ) ) / ( -6.0 ) ) ) ) );
+}
+
+static inline double tau_m_CaLVA ( const double v )
+{
+  return ( ( 5.0 + ( 20.0 / ( 1.0 + exp ( ( ( ( v + 10.0 ) - ( -25.0 ) ) / 5.0 ) ) ) ) ) / 2.952882641412121 );
+}
+
+static inline double inf_h_CaLVA ( const double v )
+{
+  return ( 1.0 / ( 1.0 + exp ( ( ( ( v + 10.0 ) - ( -80.0 ) ) / 6.4 ) ) ) );
+}
+
+static inline double tau_h_CaLVA ( const double v )
+{
+  return ( ( 20.0 + ( 50.0 / ( 1.0 + exp ( ( ( ( v + 10.0 ) - ( -40.0 ) ) / 7.0 ) ) ) ) ) / 2.952882641412121 );
+}
+
+//
+// All channels
+//
+static inline void ion_lut_initialize ( void )
+{
+#if ION_LUT == 1
+  for ( int k = 0; k < ION_LUT_N; k++ ) {
+    const double v = ION_LUT_V_MIN + ION_LUT_DV * k;
+    { double *r = &lut_NaTs [ 2 * N_GATE_NaTs * k ]; rate_NaTs_exact ( v, 0.0, r, r + N_GATE_NaTs ); }
+    { double *r = &lut_NaTa [ 2 * N_GATE_NaTa * k ]; rate_NaTa_exact ( v, 0.0, r, r + N_GATE_NaTa ); }
+    { double *r = &lut_Nap [ 2 * N_GATE_Nap * k ]; rate_Nap_exact ( v, 0.0, r, r + N_GATE_Nap ); }
+    { double *r = &lut_Kv2 [ 2 * N_GATE_Kv2 * k ]; rate_Kv2_exact ( v, 0.0, r, r + N_GATE_Kv2 ); }
+    { double *r = &lut_Kv3 [ 2 * N_GATE_Kv3 * k ]; rate_Kv3_exact ( v, 0.0, r, r + N_GATE_Kv3 ); }
+    { double *r = &lut_KP [ 2 * N_GATE_KP * k ]; rate_KP_exact ( v, 0.0, r, r + N_GATE_KP ); }
+    { double *r = &lut_KT [ 2 * N_GATE_KT * k ]; rate_KT_exact ( v, 0.0, r, r + N_GATE_KT ); }
+    { double *r = &lut_Kd [ 2 * N_GATE_Kd * k ]; rate_Kd_exact ( v, 0.0, r, r + N_GATE_Kd ); }
+    { double *r = &lut_Im [ 2 * N_GATE_Im * k ]; rate_Im_exact ( v, 0.0, r, r + N_GATE_Im ); }
+    { double *r = &lut_Imv2 [ 2 * N_GATE_Imv2 * k ]; rate_Imv2_exact ( v, 0.0, r, r + N_GATE_Imv2 ); }
+    { double *r = &lut_Ih [ 2 * N_GATE_Ih * k ]; rate_Ih_exact ( v, 0.0, r, r + N_GATE_Ih ); }
+    { double *r = &lut_CaHVA [ 2 * N_GATE_CaHVA * k ]; rate_CaHVA_exact ( v, 0.0, r, r + N_GATE_CaHVA ); }
+    { double *r = &lut_CaLVA [ 2 * N_GATE_CaLVA * k ]; rate_CaLVA_exact ( v, 0.0, r, r + N_GATE_CaLVA ); }
+  }
+#endif
+}
+
+// Exponential Euler step of the gates of the channels in mask (bit CHANNEL ( gbar ))
+static inline __attribute__ ( ( always_inline ) ) void update_gates ( const unsigned mask, const double v, const double ca, state_t * __restrict__ ion, const double dt )
+{
+  if ( mask & CHANNEL ( G_NATS ) ) {
+    double inf [ N_GATE_NaTs ], tau [ N_GATE_NaTs ];
+    rate_NaTs ( v, ca, inf, tau );
+    ion [ M_NATS ] = inf [ 0 ] + ( ion [ M_NATS ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H_NATS ] = inf [ 1 ] + ( ion [ H_NATS ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+  }
+  if ( mask & CHANNEL ( G_NATA ) ) {
+    double inf [ N_GATE_NaTa ], tau [ N_GATE_NaTa ];
+    rate_NaTa ( v, ca, inf, tau );
+    ion [ M_NATA ] = inf [ 0 ] + ( ion [ M_NATA ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H_NATA ] = inf [ 1 ] + ( ion [ H_NATA ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+  }
+  if ( mask & CHANNEL ( G_NAP ) ) {
+    double inf [ N_GATE_Nap ], tau [ N_GATE_Nap ];
+    rate_Nap ( v, ca, inf, tau );
+    ion [ H_NAP ] = inf [ 0 ] + ( ion [ H_NAP ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+  }
+  if ( mask & CHANNEL ( G_KV2 ) ) {
+    double inf [ N_GATE_Kv2 ], tau [ N_GATE_Kv2 ];
+    rate_Kv2 ( v, ca, inf, tau );
+    ion [ M_KV2 ] = inf [ 0 ] + ( ion [ M_KV2 ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H1_KV2 ] = inf [ 1 ] + ( ion [ H1_KV2 ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    ion [ H2_KV2 ] = inf [ 2 ] + ( ion [ H2_KV2 ] - inf [ 2 ] ) * exp ( - dt / tau [ 2 ] );
+  }
+  if ( mask & CHANNEL ( G_KV3 ) ) {
+    double inf [ N_GATE_Kv3 ], tau [ N_GATE_Kv3 ];
+    rate_Kv3 ( v, ca, inf, tau );
+    ion [ M_KV3 ] = inf [ 0 ] + ( ion [ M_KV3 ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+  }
+  if ( mask & CHANNEL ( G_KP ) ) {
+    double inf [ N_GATE_KP ], tau [ N_GATE_KP ];
+    rate_KP ( v, ca, inf, tau );
+    ion [ M_KP ] = inf [ 0 ] + ( ion [ M_KP ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H_KP ] = inf [ 1 ] + ( ion [ H_KP ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+  }
+  if ( mask & CHANNEL ( G_KT ) ) {
+    double inf [ N_GATE_KT ], tau [ N_GATE_KT ];
+    rate_KT ( v, ca, inf, tau );
+    ion [ M_KT ] = inf [ 0 ] + ( ion [ M_KT ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H_KT ] = inf [ 1 ] + ( ion [ H_KT ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+  }
+  if ( mask & CHANNEL ( G_KD ) ) {
+    double inf [ N_GATE_Kd ], tau [ N_GATE_Kd ];
+    rate_Kd ( v, ca, inf, tau );
+    ion [ M_KD ] = inf [ 0 ] + ( ion [ M_KD ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H_KD ] = inf [ 1 ] + ( ion [ H_KD ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+  }
+  if ( mask & CHANNEL ( G_IM ) ) {
+    double inf [ N_GATE_Im ], tau [ N_GATE_Im ];
+    rate_Im ( v, ca, inf, tau );
+    ion [ M_IM ] = inf [ 0 ] + ( ion [ M_IM ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+  }
+  if ( mask & CHANNEL ( G_IMV2 ) ) {
+    double inf [ N_GATE_Imv2 ], tau [ N_GATE_Imv2 ];
+    rate_Imv2 ( v, ca, inf, tau );
+    ion [ M_IMV2 ] = inf [ 0 ] + ( ion [ M_IMV2 ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+  }
+  if ( mask & CHANNEL ( G_IH ) ) {
+    double inf [ N_GATE_Ih ], tau [ N_GATE_Ih ];
+    rate_Ih ( v, ca, inf, tau );
+    ion [ M_IH ] = inf [ 0 ] + ( ion [ M_IH ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+  }
+  if ( mask & CHANNEL ( G_SK ) ) {
+    double inf [ N_GATE_SK ], tau [ N_GATE_SK ];
+    rate_SK ( v, ca, inf, tau );
+    ion [ Z_SK ] = inf [ 0 ] + ( ion [ Z_SK ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+  }
+  if ( mask & CHANNEL ( G_CAHVA ) ) {
+    double inf [ N_GATE_CaHVA ], tau [ N_GATE_CaHVA ];
+    rate_CaHVA ( v, ca, inf, tau );
+    ion [ M_CAHVA ] = inf [ 0 ] + ( ion [ M_CAHVA ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H_CAHVA ] = inf [ 1 ] + ( ion [ H_CAHVA ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+  }
+  if ( mask & CHANNEL ( G_CALVA ) ) {
+    double inf [ N_GATE_CaLVA ], tau [ N_GATE_CaLVA ];
+    rate_CaLVA ( v, ca, inf, tau );
+    ion [ M_CALVA ] = inf [ 0 ] + ( ion [ M_CALVA ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    ion [ H_CALVA ] = inf [ 1 ] + ( ion [ H_CALVA ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+  }
+}
+
+// Exponential Euler step of the gates of the channels in mask, in the compartments comp [ ptr [ g ] .. ptr [ g + 1 ] - 1 ]
+// of each channel g; gate s of compartment j is ion [ s * stride + j ]
+static inline __attribute__ ( ( always_inline ) ) void update_gates_comp ( const unsigned mask, const int * __restrict__ ptr, const int * __restrict__ comp,
+                                                                         const matrix_t * __restrict__ v, const double * __restrict__ ca, state_t * __restrict__ ion, const int stride, const double dt )
+{
+  if ( mask & CHANNEL ( G_NATS ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_NATS ]; k < ptr [ G_NATS + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_NaTs ], tau [ N_GATE_NaTs ];
+      rate_NaTs ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_NATS * stride + j ] = inf [ 0 ] + ( ion [ M_NATS * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H_NATS * stride + j ] = inf [ 1 ] + ( ion [ H_NATS * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_NATA ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_NATA ]; k < ptr [ G_NATA + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_NaTa ], tau [ N_GATE_NaTa ];
+      rate_NaTa ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_NATA * stride + j ] = inf [ 0 ] + ( ion [ M_NATA * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H_NATA * stride + j ] = inf [ 1 ] + ( ion [ H_NATA * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_NAP ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_NAP ]; k < ptr [ G_NAP + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_Nap ], tau [ N_GATE_Nap ];
+      rate_Nap ( v [ j ], ca [ j ], inf, tau );
+      ion [ H_NAP * stride + j ] = inf [ 0 ] + ( ion [ H_NAP * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_KV2 ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_KV2 ]; k < ptr [ G_KV2 + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_Kv2 ], tau [ N_GATE_Kv2 ];
+      rate_Kv2 ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_KV2 * stride + j ] = inf [ 0 ] + ( ion [ M_KV2 * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H1_KV2 * stride + j ] = inf [ 1 ] + ( ion [ H1_KV2 * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+      ion [ H2_KV2 * stride + j ] = inf [ 2 ] + ( ion [ H2_KV2 * stride + j ] - inf [ 2 ] ) * exp ( - dt / tau [ 2 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_KV3 ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_KV3 ]; k < ptr [ G_KV3 + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_Kv3 ], tau [ N_GATE_Kv3 ];
+      rate_Kv3 ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_KV3 * stride + j ] = inf [ 0 ] + ( ion [ M_KV3 * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_KP ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_KP ]; k < ptr [ G_KP + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_KP ], tau [ N_GATE_KP ];
+      rate_KP ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_KP * stride + j ] = inf [ 0 ] + ( ion [ M_KP * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H_KP * stride + j ] = inf [ 1 ] + ( ion [ H_KP * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_KT ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_KT ]; k < ptr [ G_KT + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_KT ], tau [ N_GATE_KT ];
+      rate_KT ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_KT * stride + j ] = inf [ 0 ] + ( ion [ M_KT * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H_KT * stride + j ] = inf [ 1 ] + ( ion [ H_KT * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_KD ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_KD ]; k < ptr [ G_KD + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_Kd ], tau [ N_GATE_Kd ];
+      rate_Kd ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_KD * stride + j ] = inf [ 0 ] + ( ion [ M_KD * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H_KD * stride + j ] = inf [ 1 ] + ( ion [ H_KD * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_IM ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_IM ]; k < ptr [ G_IM + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_Im ], tau [ N_GATE_Im ];
+      rate_Im ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_IM * stride + j ] = inf [ 0 ] + ( ion [ M_IM * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_IMV2 ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_IMV2 ]; k < ptr [ G_IMV2 + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_Imv2 ], tau [ N_GATE_Imv2 ];
+      rate_Imv2 ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_IMV2 * stride + j ] = inf [ 0 ] + ( ion [ M_IMV2 * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_IH ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_IH ]; k < ptr [ G_IH + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_Ih ], tau [ N_GATE_Ih ];
+      rate_Ih ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_IH * stride + j ] = inf [ 0 ] + ( ion [ M_IH * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_SK ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_SK ]; k < ptr [ G_SK + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_SK ], tau [ N_GATE_SK ];
+      rate_SK ( v [ j ], ca [ j ], inf, tau );
+      ion [ Z_SK * stride + j ] = inf [ 0 ] + ( ion [ Z_SK * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_CAHVA ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_CAHVA ]; k < ptr [ G_CAHVA + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_CaHVA ], tau [ N_GATE_CaHVA ];
+      rate_CaHVA ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_CAHVA * stride + j ] = inf [ 0 ] + ( ion [ M_CAHVA * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H_CAHVA * stride + j ] = inf [ 1 ] + ( ion [ H_CAHVA * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    }
+  }
+  if ( mask & CHANNEL ( G_CALVA ) ) {
+OMP_SIMD
+    for ( int k = ptr [ G_CALVA ]; k < ptr [ G_CALVA + 1 ]; k++ ) {
+      const int j = comp [ k ];
+      double inf [ N_GATE_CaLVA ], tau [ N_GATE_CaLVA ];
+      rate_CaLVA ( v [ j ], ca [ j ], inf, tau );
+      ion [ M_CALVA * stride + j ] = inf [ 0 ] + ( ion [ M_CALVA * stride + j ] - inf [ 0 ] ) * exp ( - dt / tau [ 0 ] );
+      ion [ H_CALVA * stride + j ] = inf [ 1 ] + ( ion [ H_CALVA * stride + j ] - inf [ 1 ] ) * exp ( - dt / tau [ 1 ] );
+    }
+  }
+}
+
+// Steady state of the gates of all channels; gate s is ion [ s * stride ]
+static inline void init_gates ( const double v, const double ca, state_t * __restrict__ ion, const int stride )
+{
+  { double inf [ N_GATE_NaTs ], tau [ N_GATE_NaTs ]; rate_NaTs_exact ( v, ca, inf, tau );
+    ion [ M_NATS * stride ] = inf [ 0 ]; ion [ H_NATS * stride ] = inf [ 1 ]; }
+  { double inf [ N_GATE_NaTa ], tau [ N_GATE_NaTa ]; rate_NaTa_exact ( v, ca, inf, tau );
+    ion [ M_NATA * stride ] = inf [ 0 ]; ion [ H_NATA * stride ] = inf [ 1 ]; }
+  { double inf [ N_GATE_Nap ], tau [ N_GATE_Nap ]; rate_Nap_exact ( v, ca, inf, tau );
+    ion [ H_NAP * stride ] = inf [ 0 ]; }
+  { double inf [ N_GATE_Kv2 ], tau [ N_GATE_Kv2 ]; rate_Kv2_exact ( v, ca, inf, tau );
+    ion [ M_KV2 * stride ] = inf [ 0 ]; ion [ H1_KV2 * stride ] = inf [ 1 ]; ion [ H2_KV2 * stride ] = inf [ 2 ]; }
+  { double inf [ N_GATE_Kv3 ], tau [ N_GATE_Kv3 ]; rate_Kv3_exact ( v, ca, inf, tau );
+    ion [ M_KV3 * stride ] = inf [ 0 ]; }
+  { double inf [ N_GATE_KP ], tau [ N_GATE_KP ]; rate_KP_exact ( v, ca, inf, tau );
+    ion [ M_KP * stride ] = inf [ 0 ]; ion [ H_KP * stride ] = inf [ 1 ]; }
+  { double inf [ N_GATE_KT ], tau [ N_GATE_KT ]; rate_KT_exact ( v, ca, inf, tau );
+    ion [ M_KT * stride ] = inf [ 0 ]; ion [ H_KT * stride ] = inf [ 1 ]; }
+  { double inf [ N_GATE_Kd ], tau [ N_GATE_Kd ]; rate_Kd_exact ( v, ca, inf, tau );
+    ion [ M_KD * stride ] = inf [ 0 ]; ion [ H_KD * stride ] = inf [ 1 ]; }
+  { double inf [ N_GATE_Im ], tau [ N_GATE_Im ]; rate_Im_exact ( v, ca, inf, tau );
+    ion [ M_IM * stride ] = inf [ 0 ]; }
+  { double inf [ N_GATE_Imv2 ], tau [ N_GATE_Imv2 ]; rate_Imv2_exact ( v, ca, inf, tau );
+    ion [ M_IMV2 * stride ] = inf [ 0 ]; }
+  { double inf [ N_GATE_Ih ], tau [ N_GATE_Ih ]; rate_Ih_exact ( v, ca, inf, tau );
+    ion [ M_IH * stride ] = inf [ 0 ]; }
+  { double inf [ N_GATE_SK ], tau [ N_GATE_SK ]; rate_SK_exact ( v, ca, inf, tau );
+    ion [ Z_SK * stride ] = inf [ 0 ]; }
+  { double inf [ N_GATE_CaHVA ], tau [ N_GATE_CaHVA ]; rate_CaHVA_exact ( v, ca, inf, tau );
+    ion [ M_CAHVA * stride ] = inf [ 0 ]; ion [ H_CAHVA * stride ] = inf [ 1 ]; }
+  { double inf [ N_GATE_CaLVA ], tau [ N_GATE_CaLVA ]; rate_CaLVA_exact ( v, ca, inf, tau );
+    ion [ M_CALVA * stride ] = inf [ 0 ]; ion [ H_CALVA * stride ] = inf [ 1 ]; }
+}
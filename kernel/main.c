@@ -5,6 +5,7 @@
 #include <stdlib.h> // for exit
 #include "network.h"
 #include "solver.h"
+#include "timer.h"
 #include "config.h"
 
 extern double get_time ( void );
@@ -18,9 +19,10 @@ int main ( int argc, char *argv [ ] )
   network_t *n = initialize_network ( argv [ 1 ], argv [ 2 ] );
   solver_t *s  = initialize_solver  ( n -> u );
   
+  timer_initialize ( n -> u );
   const double timer_start = get_time ( );
   for ( int t_ms = 0; t_ms < TSTOP; t_ms++ ) {
-    fprintf ( stderr, "t = %d\n", t_ms );
+    timer_progress ( t_ms );
     
     set_current ( t_ms, n, constant_current );
     solve_network ( t_ms, n, s );
@@ -28,6 +30,7 @@ int main ( int argc, char *argv [ ] )
   }
   const double timer_stop = get_time ( );
   fprintf ( stderr, "Elapsed time = %f sec.\n", timer_stop - timer_start );
+  timer_finalize ( timer_stop - timer_start );
   
   finalize_solver  ( s );
   finalize_network ( n );
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "network.h"
+#include "timer.h"
 #include "config.h"
 
 network_t *initialize_network ( const char *population_file, const char *connection_file )
@@ -13,8 +14,8 @@ network_t *initialize_network ( const char *population_file, const char *connect
   network_t *net = calloc ( 1, sizeof ( network_t ) );
   net -> u = initialize_population ( population_file );
   net -> n = initialize_neuron     ( net -> u );
-  net -> i = initialize_ion        ( net -> n );
-  net -> c = initialize_connection ( net -> u, net -> n, connection_file );
+  net -> i = initialize_ion        ( net -> u, net -> n );
+  net -> c = initialize_connection ( net -> u, net -> n, connection_file, &net -> new_id );
   net -> s = initialize_synapse    ( net -> c );
 
   net -> v_dat = fopen ( "v.dat", "w" );
@@ -22,12 +23,48 @@ network_t *initialize_network ( const char *population_file, const char *connect
 
   net -> spike = calloc ( net -> n -> n_neuron, sizeof ( int ) );
 
+  if ( QUIESCENT == 1 ) {
+    int max_comp = 0; for ( int pid = 0; pid < net -> u -> n_popl; pid++ ) { if ( net -> u -> n_comp [ pid ] > max_comp ) { max_comp = net -> u -> n_comp [ pid ]; } }
+    net -> quiescent  = calloc ( net -> n -> n_neuron, sizeof ( char ) );
+    net -> i_ext_rest = calloc ( net -> n -> n_neuron, sizeof ( double ) );
+    net -> start      = calloc ( 2 * max_comp + N_GATEVAL * ( ( ALLACTIVE == 1 ) ? max_comp : 1 ), sizeof ( double ) );
+  }
+
+  if ( ADAPTIVE == 1 ) {
+    int max_comp = 0, max_conn = 0;
+    for ( int pid = 0; pid < net -> u -> n_popl; pid++ ) { if ( net -> u -> n_comp [ pid ] > max_comp ) { max_comp = net -> u -> n_comp [ pid ]; } }
+    const conn_t *c = net -> c;
+    for ( int i = 0; i < net -> n -> n_neuron; i++ ) {
+      const int k = c -> ptr_post [ i + 1 ] - c -> ptr_post [ i ] + c -> ptr_post [ i + 1 + c -> n_post * SYN_SINGLE ] - c -> ptr_post [ i + c -> n_post * SYN_SINGLE ];
+      if ( k > max_conn ) { max_conn = k; }
+    }
+    net -> level = calloc ( net -> n -> n_neuron, sizeof ( int ) );
+    net -> slope = calloc ( net -> n -> n_neuron, sizeof ( double ) );
+    net -> saved = calloc ( 2 * max_comp + N_GATEVAL * ( ( ALLACTIVE == 1 ) ? max_comp : 1 ) + 2 * max_conn, sizeof ( double ) );
+    for ( int i = 0; i < net -> n -> n_neuron; i++ ) { net -> level [ i ] = ADAPTIVE_MAX_LEVEL; }
+  }
+
   return net;
 }
 
 void finalize_network ( network_t *net )
 {
+  if ( QUIESCENT == 1 ) {
+    const double total = ( double ) net -> n -> n_neuron * TSTOP;
+    fprintf ( stderr, "Quiescent: %ld of %.0f neuron-ms skipped (%.1f%%)\n", net -> n_skipped, total, ( total > 0 ) ? 100.0 * net -> n_skipped / total : 0.0 );
+    free ( net -> start );
+    free ( net -> i_ext_rest );
+    free ( net -> quiescent );
+  }
+  if ( ADAPTIVE == 1 ) {
+    const double total = ( double ) net -> n -> n_neuron * TSTOP;
+    fprintf ( stderr, "Adaptive: %.2f substeps per neuron-ms, %ld retries\n", ( total > 0 ) ? net -> n_substep / total : 0.0, net -> n_retry );
+    free ( net -> saved );
+    free ( net -> slope );
+    free ( net -> level );
+  }
   free ( net -> spike  );
+  free ( net -> new_id );
   fclose ( net -> s_dat );
   fclose ( net -> v_dat );
   finalize_synapse    ( net -> s );
@@ -40,7 +77,115 @@ void finalize_network ( network_t *net )
 
 void set_current ( const int t_ms, network_t *net, double ( *current ) ( const int, const int ) )
 {
-  for ( int i = 0; i < net -> n -> n_neuron; i++ ) { net -> n -> i_ext [ net -> n -> sid [ i ] ] = current ( t_ms, i ); }
+  for ( int i = 0; i < net -> n -> n_neuron; i++ ) { net -> n -> i_ext [ net -> n -> sid [ net -> new_id [ i ] ] ] = current ( t_ms, i ); }
+}
+
+//
+// Quiescent fast path (QUIESCENT == 1).
+// A neuron is at rest when no synaptic trace exceeds QUIESCENT_SUM0 and, over the last ms, no compartment moved by more
+// than QUIESCENT_DV in v or QUIESCENT_DCA in Ca2+, and no gate by more than QUIESCENT_DGATE, so that slow gates and Ca2+
+// still relaxing keep it solved. It is then held at its state, which is a steady state up to these thresholds, and is not
+// solved until a synaptic input arrives or its somatic current changes (set_current only drives the soma).
+//
+static int has_input ( const network_t *net, const int id )
+{
+  const conn_t *c = net -> c;
+  for ( long j = c -> ptr_post [ id ]; j < c -> ptr_post [ id + 1 ]; j++ ) {
+    if ( fabs ( net -> s -> sum0 [ j ] ) > QUIESCENT_SUM0 || fabs ( net -> s -> sum1 [ j ] ) > QUIESCENT_SUM0 ) { return 1; }
+  }
+  for ( long j = c -> ptr_post [ id + c -> n_post * SYN_SINGLE ]; j < c -> ptr_post [ id + 1 + c -> n_post * SYN_SINGLE ]; j++ ) {
+    if ( fabs ( net -> s -> sum0 [ j ] ) > QUIESCENT_SUM0 ) { return 1; }
+  }
+  return ( net -> n -> i_ext [ net -> n -> sid [ id ] ] != net -> i_ext_rest [ id ] );
+}
+
+static void save_start ( network_t *net, const int id )
+{
+  const neuron_t *n = net -> n;
+  const int sid = n -> sid [ id ], n_comp = net -> u -> n_comp [ n -> pid [ id ] ];
+  const int n_gate = N_GATEVAL * GATE_STRIDE ( net -> u, n -> pid [ id ] );
+  double *v = net -> start, *ca = v + n_comp, *gate = ca + n_comp;
+  const state_t *g = &net -> i -> gate [ GATE_OFFSET ( n, id ) ];
+  for ( int j = 0; j < n_comp; j++ ) { v [ j ] = n -> v [ sid + j ]; ca [ j ] = n -> ca [ sid + j ]; }
+  for ( int k = 0; k < n_gate; k++ ) { gate [ k ] = g [ k ]; }
+}
+
+static int at_rest ( const network_t *net, const int id )
+{
+  const neuron_t *n = net -> n;
+  const int sid = n -> sid [ id ], n_comp = net -> u -> n_comp [ n -> pid [ id ] ];
+  const int n_gate = N_GATEVAL * GATE_STRIDE ( net -> u, n -> pid [ id ] );
+  const double *v = net -> start, *ca = v + n_comp, *gate = ca + n_comp;
+  const state_t *g = &net -> i -> gate [ GATE_OFFSET ( n, id ) ];
+  for ( int j = 0; j < n_comp; j++ ) {
+    if ( fabs ( n -> v [ sid + j ] - v [ j ] ) > QUIESCENT_DV || fabs ( n -> ca [ sid + j ] - ca [ j ] ) > QUIESCENT_DCA ) { return 0; }
+  }
+  for ( int k = 0; k < n_gate; k++ ) { if ( fabs ( g [ k ] - gate [ k ] ) > QUIESCENT_DGATE ) { return 0; } }
+  return ! has_input ( net, id );
+}
+
+//
+// Adaptive step (ADAPTIVE == 1).
+// Each neuron advances by 1 ms in substeps of equal size, so the 1 ms synchronization points stay fixed.
+// The finest level ADAPTIVE_MAX_LEVEL uses DT, and every level below halves the # of substeps (rounded up).
+// The local error of a substep is estimated from the change of the somatic dv/dt between consecutive substeps,
+// which is h^2 v'' for a step h. If an estimate exceeds ADAPTIVE_TOL, the ms is redone with twice as many substeps
+// from the saved state; if all estimates are below ADAPTIVE_TOL / 4, the next ms uses half as many.
+//
+static void save_state ( network_t *net, const int id, const int restore )
+{
+  neuron_t *n = net -> n;
+  const int sid = n -> sid [ id ], n_comp = net -> u -> n_comp [ n -> pid [ id ] ];
+  const conn_t *c = net -> c;
+  const long c0 = c -> ptr_post [ id ], c1 = c -> ptr_post [ id + c -> n_post * SYN_SINGLE ]; // double and single exponential
+  const int n_conn0 = c -> ptr_post [ id + 1 ] - c0, n_conn1 = c -> ptr_post [ id + 1 + c -> n_post * SYN_SINGLE ] - c1;
+  const int n_gate = N_GATEVAL * GATE_STRIDE ( net -> u, n -> pid [ id ] );
+  double *v = net -> saved, *ca = v + n_comp, *gate = ca + n_comp, *sum0 = gate + n_gate, *sum1 = sum0 + n_conn0, *sum0_single = sum1 + n_conn0;
+  state_t *g = &net -> i -> gate [ GATE_OFFSET ( n, id ) ];
+  if ( restore ) {
+    for ( int j = 0; j < n_comp; j++ ) { n -> v [ sid + j ] = v [ j ]; n -> ca [ sid + j ] = ca [ j ]; }
+    for ( int k = 0; k < n_gate; k++ ) { g [ k ] = gate [ k ]; }
+    for ( int k = 0; k < n_conn0; k++ ) { net -> s -> sum0 [ c0 + k ] = sum0 [ k ]; net -> s -> sum1 [ c0 + k ] = sum1 [ k ]; }
+    for ( int k = 0; k < n_conn1; k++ ) { net -> s -> sum0 [ c1 + k ] = sum0_single [ k ]; }
+  } else {
+    for ( int j = 0; j < n_comp; j++ ) { v [ j ] = n -> v [ sid + j ]; ca [ j ] = n -> ca [ sid + j ]; }
+    for ( int k = 0; k < n_gate; k++ ) { gate [ k ] = g [ k ]; }
+    for ( int k = 0; k < n_conn0; k++ ) { sum0 [ k ] = net -> s -> sum0 [ c0 + k ]; sum1 [ k ] = net -> s -> sum1 [ c0 + k ]; }
+    for ( int k = 0; k < n_conn1; k++ ) { sum0_single [ k ] = net -> s -> sum0 [ c1 + k ]; }
+  }
+}
+
+static int solve_adaptive ( network_t *net, solver_t *solver, const int id, double *v_hist )
+{
+  neuron_t *n = net -> n;
+  const int sid = n -> sid [ id ];
+  save_state ( net, id, 0 );
+  for ( ; ; ) {
+    const int shift = ADAPTIVE_MAX_LEVEL - net -> level [ id ];
+    const int n_step = ( INV_DT + ( 1 << shift ) - 1 ) >> shift;
+    const double h = 1.0 / n_step;
+    double v_prev = n -> v [ sid ], slope = net -> slope [ id ], error = 0.0;
+    int spike = 0;
+    for ( int iter = 0, k = 0; iter < n_step; iter++ ) {
+      for ( ; k < INV_DT && ( k * n_step ) / INV_DT <= iter; k++ ) { v_hist [ k ] = n -> v [ sid ]; }
+      solve_step ( id, net -> u, net -> n, net -> i, net -> c, net -> s, solver, h );
+      spike += ( v_prev <= SPIKE_THRESHOLD && n -> v [ sid ] > SPIKE_THRESHOLD );
+      const double s = ( n -> v [ sid ] - v_prev ) / h;
+      error = fmax ( error, fabs ( s - slope ) * h );
+      slope = s;
+      v_prev = n -> v [ sid ];
+    }
+    net -> n_substep += n_step;
+    if ( error > ADAPTIVE_TOL && net -> level [ id ] < ADAPTIVE_MAX_LEVEL ) {
+      save_state ( net, id, 1 );
+      net -> level [ id ]++;
+      net -> n_retry++;
+      continue;
+    }
+    net -> slope [ id ] = slope;
+    if ( error < 0.25 * ADAPTIVE_TOL && net -> level [ id ] > 0 ) { net -> level [ id ]--; }
+    return ( spike > 0 );
+  }
 }
 
 void solve_network ( const int t_ms, network_t *net, solver_t *solver )
@@ -50,34 +195,64 @@ void solve_network ( const int t_ms, network_t *net, solver_t *solver )
   double *v_hist = calloc ( n -> n_neuron * INV_DT, sizeof ( double ) );
   
   for ( int i = 0; i < n -> n_neuron; i++ ) {
+    TIMER_BEGIN ( t0 );
     const int sid = n -> sid [ i ];
-    double v_prev = n -> v [ sid ];
+    const int inv_dt = net -> u -> inv_dt [ n -> pid [ i ] ];
+    if ( QUIESCENT == 1 && net -> quiescent [ i ] ) {
+      if ( ! has_input ( net, i ) ) {
+	for ( int iter = 0; iter < INV_DT; iter++ ) { v_hist [ iter + INV_DT * i ] = n -> v [ sid ]; }
+	TIMER_BEGIN ( t1 );
+	for ( int iter = 0; iter < inv_dt; iter++ ) { update_synapse ( i, net -> c, net -> s ); }
+	TIMER_END ( t1, T_SYNAPSE, n -> pid [ i ] );
+	net -> spike [ i ] = 0;
+	net -> n_skipped++;
+	TIMER_END ( t0, T_SPIKE, n -> pid [ i ] );
+	continue;
+      }
+      net -> quiescent [ i ] = 0;
+    }
+    if ( QUIESCENT == 1 ) { save_start ( net, i ); }
     int spike = 0;
-    for ( int iter = 0; iter < INV_DT; iter++ ) {
-      v_hist [ iter + INV_DT * i ] = n -> v [ sid ];
-      solve ( i, net -> u, net -> n, net -> i, net -> c, net -> s, solver );
-      spike += ( v_prev <= SPIKE_THRESHOLD && n -> v [ sid ] > SPIKE_THRESHOLD );
-      v_prev = n -> v [ sid ];
+    if ( ADAPTIVE == 1 ) {
+      spike = solve_adaptive ( net, solver, i, &v_hist [ INV_DT * i ] );
+    } else {
+      // Each population runs inv_dt substeps per ms; v is sampled on the output grid of DT,
+      // and spikes are detected on the grid of the population
+      double v_prev = n -> v [ sid ];
+      for ( int iter = 0, k = 0; iter < inv_dt; iter++ ) {
+	for ( ; k < INV_DT && ( k * inv_dt ) / INV_DT <= iter; k++ ) { v_hist [ k + INV_DT * i ] = n -> v [ sid ]; }
+	solve ( i, net -> u, net -> n, net -> i, net -> c, net -> s, solver );
+	spike += ( v_prev <= SPIKE_THRESHOLD && n -> v [ sid ] > SPIKE_THRESHOLD );
+	v_prev = n -> v [ sid ];
+      }
     }
     net -> spike [ i ] = ( spike > 0 );
+    if ( QUIESCENT == 1 && ! spike && at_rest ( net, i ) ) { net -> quiescent [ i ] = 1; net -> i_ext_rest [ i ] = n -> i_ext [ sid ]; }
+    TIMER_END ( t0, T_SPIKE, n -> pid [ i ] ); // the phases inside solve are subtracted in the report
   }
 
+  TIMER_BEGIN ( t1 );
   for ( int iter = 0; iter < INV_DT; iter++ ) {
     fprintf ( net -> v_dat, "%f ", t_ms + DT * iter );
     for ( int i = 0; i < n -> n_neuron; i++ ) {
-      if ( isnan ( v_hist [ iter + INV_DT * i ] ) ) { fprintf ( stderr, "nan: %d\n", i ); exit ( 1 ); }
-      fprintf ( net -> v_dat, "%f%s", v_hist [ iter + INV_DT * i ], ( i == n -> n_neuron - 1 ) ? "\n" : " " );
+      const double v = v_hist [ iter + INV_DT * net -> new_id [ i ] ];
+      if ( isnan ( v ) ) { fprintf ( stderr, "nan: %d\n", i ); exit ( 1 ); }
+      fprintf ( net -> v_dat, "%f%s", v, ( i == n -> n_neuron - 1 ) ? "\n" : " " );
     }
   }
+  TIMER_END ( t1, T_OUTPUT, -1 );
   
   free ( v_hist );
 }
 
 void spike_propagation ( const int t_ms, network_t *net )
 {
+  TIMER_BEGIN ( t0 );
   for ( int i = 0; i < net -> n -> n_neuron; i++ ) {
-    if ( net -> spike [ i ] ) { fprintf ( net -> s_dat, "%d %d\n", t_ms, i ); }
+    if ( net -> spike [ net -> new_id [ i ] ] ) { fprintf ( net -> s_dat, "%d %d\n", t_ms, i ); }
   }
+  TIMER_END ( t0, T_OUTPUT, -1 );
+  TIMER_BEGIN ( t1 );
 
   add_spike_to_synapse_per_ms ( net -> c, net -> s ); // Add spike after delayed period is over
 
@@ -99,7 +274,7 @@ void spike_propagation ( const int t_ms, network_t *net )
     } else if ( spiking_neurons [ neuron_idx ] > c -> pre_table [ table_idx ] ) {
       table_idx++;
     } else {
-      for ( int j = c -> ptr_pre [ table_idx ]; j < c -> ptr_pre [ table_idx + 1 ]; j++ ) {
+      for ( long j = c -> ptr_pre [ table_idx ]; j < c -> ptr_pre [ table_idx + 1 ]; j++ ) {
 	s -> delay [ c -> id [ j ] ] = ( 1 << c -> delay [ j ] );
       }
       table_idx++;
@@ -107,4 +282,5 @@ void spike_propagation ( const int t_ms, network_t *net )
     }
   }
   free ( spiking_neurons );
+  TIMER_END ( t1, T_PROPAGATION, -1 );
 }
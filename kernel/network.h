@@ -9,6 +9,7 @@
 #include "conn.h"
 #include "synapse.h"
 #include "solver.h"
+#include "reorder.h"
 
 typedef struct {
   population_t *u;
@@ -18,6 +19,17 @@ typedef struct {
   synapse_t    *s;
   FILE *v_dat, *s_dat;
   int *spike;
+  int *new_id; // new_id [ id in the CSV files and outputs ] == internal neuron id
+  // Quiescent fast path (QUIESCENT == 1)
+  char *quiescent;    // 1 == the neuron is at rest and is not solved
+  double *i_ext_rest; // somatic current when the neuron came to rest
+  double *start;      // scratch; v and ca of all compartments and the gates at the beginning of the ms
+  long n_skipped;     // # neuron-ms skipped
+  // Adaptive step (ADAPTIVE == 1)
+  int *level;         // level of the neuron in the next ms; ADAPTIVE_MAX_LEVEL == DT
+  double *slope;      // somatic dv/dt of the last substep [mV/ms]
+  double *saved;      // scratch; state of a neuron at the beginning of the ms
+  long n_substep, n_retry;
 } network_t;
 
 extern network_t *initialize_network ( const char *, const char * );
@@ -27,6 +27,12 @@ static population_t *initialize ( const int n_popl, const int n_neuron [ ], cons
     u -> n_comp   [ i ] = n_comp   [ i ];
     u -> cid [ i + 1 ]  = u -> cid [ i ] + u -> n_comp [ i ];
   }
+  u -> swc_cid = calloc ( ( u -> n_popl + 1 ), sizeof ( int ) );
+  for ( int i = 0; i <= u -> n_popl; i++ ) { u -> swc_cid [ i ] = u -> cid [ i ]; }
+
+  u -> inv_dt = calloc ( u -> n_popl, sizeof ( int ) );
+  u -> dt     = calloc ( u -> n_popl, sizeof ( double ) );
+  for ( int i = 0; i < u -> n_popl; i++ ) { u -> inv_dt [ i ] = INV_DT; u -> dt [ i ] = DT; }
 
   const int nc = u -> cid [ u -> n_popl ]; // total number of compartments
 
@@ -35,6 +41,7 @@ static population_t *initialize ( const int n_popl, const int n_neuron [ ], cons
   u -> area = calloc ( nc, sizeof ( double ) );
   u -> parent = calloc ( nc, sizeof ( int ) );
   u -> type   = calloc ( nc, sizeof ( int ) );
+  u -> cmap   = calloc ( nc, sizeof ( int ) );
 
   u -> cm = calloc ( nc, sizeof ( double ) );
   u -> ra = calloc ( nc, sizeof ( double ) );
@@ -44,11 +51,84 @@ static population_t *initialize ( const int n_popl, const int n_neuron [ ], cons
   u -> gamma = calloc ( n_popl * N_COMPTYPE, sizeof ( double ) );
   u -> decay = calloc ( n_popl * N_COMPTYPE, sizeof ( double ) );
 
-  u -> gbar  = calloc ( ( ( ALLACTIVE == 1 ) ? nc : n_popl ) * N_GBAR, sizeof ( double ) ); // Default is perisomatic
+  u -> gbar  = calloc ( n_popl * N_GBAR, sizeof ( double ) ); // Default is perisomatic
+  u -> gdens = calloc ( n_popl * N_COMPTYPE * N_GBAR, sizeof ( double ) );
+  u -> channel = calloc ( n_popl, sizeof ( unsigned ) );
 
   return u;
 }
 
+// d_lambda rule (DLAMBDA > 0): the compartments of all populations are laid out again with their new numbers
+static void discretize_compartments ( population_t *u )
+{
+  population_t w = { .n_popl = u -> n_popl };
+  w.n_comp = calloc ( u -> n_popl, sizeof ( int ) );
+  w.cid = calloc ( ( u -> n_popl + 1 ), sizeof ( int ) );
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) {
+    w.n_comp [ pid ] = discretize_morphology ( u, &w, pid ); // count
+    w.cid [ pid + 1 ] = w.cid [ pid ] + w.n_comp [ pid ];
+  }
+
+  const int nc = w.cid [ w.n_popl ];
+  w.rad = calloc  ( nc, sizeof ( double ) );
+  w.len = calloc  ( nc, sizeof ( double ) );
+  w.area = calloc ( nc, sizeof ( double ) );
+  w.parent = calloc ( nc, sizeof ( int ) );
+  w.type   = calloc ( nc, sizeof ( int ) );
+  w.cm = calloc ( nc, sizeof ( double ) );
+  w.ra = calloc ( nc, sizeof ( double ) );
+  w.gl = calloc ( nc, sizeof ( double ) );
+  w.vl = calloc ( nc, sizeof ( double ) );
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) {
+    discretize_morphology ( u, &w, pid ); // fill
+    fprintf ( stderr, "d_lambda: population %d, %d -> %d compartments\n", pid, u -> n_comp [ pid ], w.n_comp [ pid ] );
+  }
+
+  free ( u -> n_comp ); u -> n_comp = w.n_comp;
+  free ( u -> cid );    u -> cid    = w.cid;
+  free ( u -> rad );    u -> rad    = w.rad;
+  free ( u -> len );    u -> len    = w.len;
+  free ( u -> area );   u -> area   = w.area;
+  free ( u -> parent ); u -> parent = w.parent;
+  free ( u -> type );   u -> type   = w.type;
+  free ( u -> cm );     u -> cm     = w.cm;
+  free ( u -> ra );     u -> ra     = w.ra;
+  free ( u -> gl );     u -> gl     = w.gl;
+  free ( u -> vl );     u -> vl     = w.vl;
+}
+
+// All-active: list the compartments that have each channel, in increasing order, so that the kernels visit only those
+static void list_channel_comp ( population_t *u )
+{
+  u -> chan_ptr = calloc ( u -> n_popl * N_CHAN_LIST + 1, sizeof ( int ) );
+  for ( int pass = 0; pass < 2; pass++ ) { // count, then fill
+    int k = 0;
+    for ( int pid = 0; pid < u -> n_popl; pid++ ) {
+      const int *type = &u -> type [ u -> cid [ pid ] ];
+      const double *gdens = &u -> gdens [ N_GBAR * N_COMPTYPE * pid ];
+      for ( int g = 0; g < N_CHAN_LIST; g++ ) {
+	u -> chan_ptr [ g + N_CHAN_LIST * pid ] = k;
+	for ( int j = 0; j < u -> n_comp [ pid ]; j++ ) {
+	  const double *d = &gdens [ N_GBAR * type [ j ] ];
+	  if ( ( g == CA_COMP ) ? ( d [ G_CAHVA ] == 0.0 && d [ G_CALVA ] == 0.0 ) : ( d [ g ] == 0.0 ) ) { continue; }
+	  if ( pass == 1 ) { u -> chan_comp [ k ] = j; }
+	  k++;
+	}
+      }
+    }
+    u -> chan_ptr [ u -> n_popl * N_CHAN_LIST ] = k;
+    if ( pass == 0 ) { u -> chan_comp = calloc ( ( k > 0 ) ? k : 1, sizeof ( int ) ); }
+  }
+
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) {
+    u -> channel [ pid ] = 0;
+    for ( int g = 0; g < N_GBAR; g++ ) {
+      const int *ptr = &u -> chan_ptr [ g + N_CHAN_LIST * pid ];
+      if ( ptr [ 1 ] > ptr [ 0 ] || CHANNEL_SPECIALIZE == 0 ) { u -> channel [ pid ] |= CHANNEL ( g ); }
+    }
+  }
+}
+
 population_t *initialize_population ( const char *filename )
 {
   int n_popl = get_lines ( filename );
@@ -66,18 +146,33 @@ population_t *initialize_population ( const char *filename )
   while ( fgets ( buf, 1024, file ) ) {
     if ( strip_comment_destructive ( buf ) == 0 ) { continue; }
     if ( remove_blank_destructive_for_csv ( buf ) == 0 ) { continue; }
-    int dn_neuron, dn_comp;
+    int dn_neuron, dn_comp, dn_substep;
     char name [ 1024 ], swcfile [ 1024 ], ionfile [ 1024 ];
-    const int nf = sscanf ( buf, "%d,%d,%[^,],%[^,],%[^,]", &dn_neuron, &dn_comp, name, swcfile, ionfile );
-    assert ( nf == 5 );
+    const int nf = sscanf ( buf, "%d,%d,%[^,],%[^,],%[^,],%d", &dn_neuron, &dn_comp, name, swcfile, ionfile, &dn_substep );
+    assert ( nf == 5 || nf == 6 );
+    if ( nf == 6 ) { // optional: # substeps per ms of this population
+      if ( dn_substep <= 0 ) { fprintf ( stderr, "Error: # substeps of %s must be positive\n", name ); exit ( 1 ); }
+      u -> inv_dt [ pid ] = dn_substep;
+      u -> dt     [ pid ] = 1.0 / dn_substep;
+    }
     read_swc_file ( u, pid, swcfile );
     read_pas_file ( u, pid, ionfile );
     read_ion_file ( u, pid, ionfile );
+    // Channels without conductance are not evaluated (CHANNEL_SPECIALIZE)
+    u -> channel [ pid ] = ALL_CHANNELS;
+    if ( CHANNEL_SPECIALIZE == 1 ) {
+      u -> channel [ pid ] = 0;
+      for ( int g = 0; g < N_GBAR; g++ ) { if ( u -> gbar [ g + N_GBAR * pid ] != 0.0 ) { u -> channel [ pid ] |= CHANNEL ( g ); } }
+    }
     pid++;
   }
 
   fclose ( file );
 
+  if ( DLAMBDA > 0.0 ) { discretize_compartments ( u ); }
+  for ( int pid = 0; pid < u -> n_popl; pid++ ) { renumber_compartments ( u, pid ); }
+  if ( ALLACTIVE == 1 ) { list_channel_comp ( u ); }
+
   return u;
 }
 
@@ -86,12 +181,16 @@ void finalize_population ( population_t *u )
   free ( u -> n_neuron );
   free ( u -> n_comp );
   free ( u -> cid );
+  free ( u -> inv_dt );
+  free ( u -> dt );
 
   free ( u -> rad );
   free ( u -> len );
   free ( u -> area );
   free ( u -> parent );
   free ( u -> type );
+  free ( u -> cmap );
+  free ( u -> swc_cid );
 
   free ( u -> cm );
   free ( u -> ra );
@@ -99,6 +198,10 @@ void finalize_population ( population_t *u )
   free ( u -> vl );
 
   free ( u -> gbar );
+  free ( u -> gdens );
+  free ( u -> chan_ptr );
+  free ( u -> chan_comp );
+  free ( u -> channel );
   free ( u -> gamma );
   free ( u -> decay );
 
@@ -10,6 +10,7 @@ typedef struct {
   // Morphology
   double *rad, *len, *area; // size == # populations * # compartments
   int *parent, *type; // size == # populations * # compartments
+  int *cmap, *swc_cid; // compartment id of each SWC compartment (RENUMBER, DLAMBDA), cmap [ swc_cid [ pid ] + SWC id ]; swc_cid is cid as in the population CSV
 
   // Passive
   double *cm, *ra, *gl, *vl; // size == # populations * # compartments
@@ -18,8 +19,15 @@ typedef struct {
   int *n_neuron, *n_comp, *cid; // size == # populations; cid = compartment id
   int n_popl;
 
+  // Time step
+  int *inv_dt; // size == # populations; # substeps per ms (INV_DT unless given in the population CSV)
+  double *dt;  // size == # populations; [ms]
+
   // Conductances, Ca2+ params (gamma, decay)
   double *gbar, *gamma, *decay; // size == # populations * N_GBAR (gbar, perisomatic); size == # populations * N_COMPTYPE (gamma, decay)
+  double *gdens; // size == # populations * N_COMPTYPE * N_GBAR; channel densities [S/cm^2] of each compartment type (all-active)
+  int *chan_ptr, *chan_comp; // all-active: compartments with a nonzero density of the channel g, chan_comp [ chan_ptr [ g + N_CHAN_LIST * pid ] .. chan_ptr [ g + 1 + N_CHAN_LIST * pid ] - 1 ]
+  unsigned *channel; // size == # populations; bit g is set when the channel g has a nonzero gbar (perisomatic), or is in some compartment (all-active)
 
 } population_t;
 
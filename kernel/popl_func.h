@@ -173,6 +173,7 @@ static void read_swc_file ( population_t *p, const int pid, const char *filename
 
   int n_comp = st -> size;
   p -> n_comp [ pid ] = n_comp; // update n_comp
+  for ( int i = 0; i < n_comp; i++ ) { p -> cmap [ p -> swc_cid [ pid ] + i ] = i; }
   
   const int offset = p -> cid [ pid ];
   double *rad  = &p -> rad  [ offset ];
@@ -200,6 +201,174 @@ static void read_swc_file ( population_t *p, const int pid, const char *filename
   free ( st );
 }
 
+//
+// Renumbering of the compartments of a morphology for the Hines solver (RENUMBER == 1).
+// Depth first from the soma, so that every unbranched path is a contiguous run (parent == id - 1) that the solver walks
+// without jumps, and the number of breaks is the minimum; at each branch point the smallest subtree is visited first,
+// which minimizes the distance from the first compartment of each branch back to its parent (the jumps of the solver).
+// Parents stay before their children and the soma stays 0.
+// The morphology and the passive parameters are permuted, and cmap is composed with the new ids.
+//
+static void renumber_compartments ( population_t *p, const int pid )
+{
+  const int n = p -> n_comp [ pid ], offset = p -> cid [ pid ];
+  if ( RENUMBER == 0 || n < 2 ) { return; }
+
+  int *parent = &p -> parent [ offset ];
+  for ( int i = 1; i < n; i++ ) {
+    if ( parent [ i ] < 0 || parent [ i ] >= i ) { fprintf ( stderr, "Error: compartment %d of population %d precedes its parent\n", i, pid ); exit ( 1 ); }
+  }
+  int *size = calloc ( n, sizeof ( int ) ), *child_ptr = calloc ( n + 1, sizeof ( int ) ), *child = calloc ( n, sizeof ( int ) );
+  int *stack = calloc ( n, sizeof ( int ) ), *order = calloc ( n, sizeof ( int ) ), *new_id = calloc ( n, sizeof ( int ) );
+  for ( int i = n - 1; i >= 0; i-- ) { size [ i ]++; if ( i > 0 ) { size [ parent [ i ] ] += size [ i ]; } } // # compartments of the subtree
+  for ( int i = 1; i < n; i++ ) { child_ptr [ parent [ i ] + 1 ]++; }
+  for ( int i = 0; i < n; i++ ) { child_ptr [ i + 1 ] += child_ptr [ i ]; }
+  for ( int i = 1; i < n; i++ ) { child [ child_ptr [ parent [ i ] ] + order [ parent [ i ] ]++ ] = i; } // order counts the children here
+
+  // Preorder; the children are pushed largest subtree first, so the smallest is taken next (ties in SWC order)
+  int n_stack = 0, k = 0;
+  stack [ n_stack++ ] = 0;
+  while ( n_stack > 0 ) {
+    const int i = stack [ --n_stack ];
+    order [ k++ ] = i;
+    int *c = &child [ child_ptr [ i ] ];
+    const int m = child_ptr [ i + 1 ] - child_ptr [ i ];
+    for ( int a = 1; a < m; a++ ) { // insertion sort by decreasing size, later SWC id first among equals
+      const int x = c [ a ]; int b = a;
+      while ( b > 0 && ( size [ c [ b - 1 ] ] < size [ x ] || ( size [ c [ b - 1 ] ] == size [ x ] && c [ b - 1 ] < x ) ) ) { c [ b ] = c [ b - 1 ]; b--; }
+      c [ b ] = x;
+    }
+    for ( int a = 0; a < m; a++ ) { stack [ n_stack++ ] = c [ a ]; }
+  }
+  for ( int j = 0; j < n; j++ ) { new_id [ order [ j ] ] = j; }
+  int *cmap = &p -> cmap [ p -> swc_cid [ pid ] ];
+  for ( int j = 0; j < p -> swc_cid [ pid + 1 ] - p -> swc_cid [ pid ]; j++ ) { cmap [ j ] = new_id [ cmap [ j ] ]; }
+
+  // Permute the compartments
+  double *f = calloc ( n, sizeof ( double ) );
+  double *d [ ] = { &p -> rad [ offset ], &p -> len [ offset ], &p -> area [ offset ], &p -> cm [ offset ], &p -> ra [ offset ], &p -> gl [ offset ], &p -> vl [ offset ] };
+  for ( int a = 0; a < ( int ) ( sizeof ( d ) / sizeof ( d [ 0 ] ) ); a++ ) {
+    for ( int j = 0; j < n; j++ ) { f [ j ] = d [ a ] [ order [ j ] ]; } for ( int j = 0; j < n; j++ ) { d [ a ] [ j ] = f [ j ]; }
+  }
+  int *type = &p -> type [ offset ], *g = stack; // reused
+  for ( int j = 0; j < n; j++ ) { g [ j ] = type [ order [ j ] ]; } for ( int j = 0; j < n; j++ ) { type [ j ] = g [ j ]; }
+  for ( int j = 0; j < n; j++ ) { g [ j ] = ( j == 0 ) ? -1 : new_id [ parent [ order [ j ] ] ]; } for ( int j = 0; j < n; j++ ) { parent [ j ] = g [ j ]; }
+
+  free ( f );
+  free ( new_id );
+  free ( order );
+  free ( stack );
+  free ( child );
+  free ( child_ptr );
+  free ( size );
+}
+
+//
+// Re-discretization of a morphology by the d_lambda rule of NEURON (DLAMBDA > 0).
+// Each unbranched section of one compartment type is cut into the odd number of compartments that makes each of them
+// at most DLAMBDA of the AC length constant at DLAMBDA_FREQ long, so that short SWC segments are merged and long ones split.
+// A compartment takes the share of the area, capacitance, leak and axial resistance of the SWC compartments that it covers
+// (in electrotonic length), so that the totals of the section are preserved; its radius gives that axial resistance.
+// Compartments of the soma are kept. An SWC compartment maps (cmap) to the compartment that covers its middle.
+// The rule bounds the error of the subthreshold attenuation. The proximal dendrites also load the soma during each spike
+// (kHz), so the firing rate converges more slowly: on test/kernel-test 0.1 lengthens the ISI by 2%, 0.03 by 1% at most.
+// Returns the # compartments of the population pid; they are written into w unless w -> rad is NULL.
+//
+static int discretize_morphology ( population_t *u, population_t *w, const int pid )
+{
+  const int n = u -> n_comp [ pid ], offset = u -> cid [ pid ];
+  const double *rad = &u -> rad [ offset ], *len = &u -> len [ offset ], *area = &u -> area [ offset ];
+  const double *cm = &u -> cm [ offset ], *ra = &u -> ra [ offset ], *gl = &u -> gl [ offset ], *vl = &u -> vl [ offset ];
+  const int *parent = &u -> parent [ offset ], *type = &u -> type [ offset ];
+  for ( int i = 1; i < n; i++ ) {
+    if ( parent [ i ] < 0 || parent [ i ] >= i ) { fprintf ( stderr, "Error: compartment %d of population %d precedes its parent\n", i, pid ); exit ( 1 ); }
+  }
+
+  int *n_child = calloc ( n, sizeof ( int ) ), *next = calloc ( n, sizeof ( int ) ); // next: the last child
+  int *tail = calloc ( n, sizeof ( int ) ), *new_id = calloc ( n, sizeof ( int ) ); // tail: the new compartment that the children of i attach to
+  double *e = calloc ( n, sizeof ( double ) ); // electrotonic length
+  for ( int i = 1; i < n; i++ ) { n_child [ parent [ i ] ]++; next [ parent [ i ] ] = i; }
+  for ( int i = 0; i < n; i++ ) {
+    // lambda_f = sqrt ( d / ( 4 pi f Ra Cm ) ) [cm]; d [cm], Ra [Ohm cm], Cm [F/cm^2]
+    const double c_m = ( area [ i ] > 0.0 ) ? cm [ i ] / area [ i ] * 1.0e-6 : 0.0;
+    e [ i ] = ( c_m > 0.0 ) ? len [ i ] / sqrt ( 2.0 * rad [ i ] / ( 4.0 * M_PI * DLAMBDA_FREQ * ra [ i ] * 1.0e3 * c_m ) ) : 0.0;
+  }
+#define SECTION_CONTINUES(i) ( n_child [ i ] == 1 && type [ next [ i ] ] == type [ i ] && type [ i ] != SOMA )
+
+  const int fill = ( w -> rad != NULL ), w_offset = w -> cid [ pid ];
+  int k = 0;
+  for ( int i = 0; i < n; i++ ) {
+    if ( i > 0 && SECTION_CONTINUES ( parent [ i ] ) ) { continue; } // not the first compartment of a section
+    const int k_parent = ( i == 0 ) ? -1 : tail [ parent [ i ] ];
+    if ( type [ i ] == SOMA ) {
+      if ( fill ) {
+	const int q = w_offset + k;
+	w -> rad [ q ] = rad [ i ]; w -> len [ q ] = len [ i ]; w -> area [ q ] = area [ i ];
+	w -> cm [ q ] = cm [ i ]; w -> ra [ q ] = ra [ i ]; w -> gl [ q ] = gl [ i ]; w -> vl [ q ] = vl [ i ];
+	w -> parent [ q ] = k_parent; w -> type [ q ] = type [ i ];
+      }
+      new_id [ i ] = tail [ i ] = k++;
+      continue;
+    }
+
+    double el = 0.0; // of the section
+    for ( int j = i; ; j = next [ j ] ) { el += e [ j ]; if ( ! SECTION_CONTINUES ( j ) ) { break; } }
+    const int nseg = ( int ) ( ( el / DLAMBDA + 0.9 ) / 2.0 ) * 2 + 1;
+    if ( fill ) {
+      for ( int s = 0; s < nseg; s++ ) { // sums; rad holds the axial resistance, vl the leak current at 0 mV
+	const int q = w_offset + k + s;
+	w -> rad [ q ] = w -> len [ q ] = w -> area [ q ] = w -> cm [ q ] = w -> gl [ q ] = w -> vl [ q ] = 0.0;
+	w -> ra [ q ] = ra [ i ];
+	w -> parent [ q ] = ( s == 0 ) ? k_parent : k + s - 1;
+	w -> type [ q ] = type [ i ];
+      }
+    }
+    double x = 0.0; // electrotonic distance from the start of the section
+    for ( int j = i; ; j = next [ j ] ) {
+      const double x_end = x + e [ j ];
+      int s     = ( el > 0.0 ) ? ( int ) ( x * nseg / el ) : 0; // first new compartment that j overlaps
+      int s_mid = ( el > 0.0 ) ? ( int ) ( ( x + 0.5 * e [ j ] ) * nseg / el ) : 0;
+      if ( s     > nseg - 1 ) { s     = nseg - 1; }
+      if ( s_mid > nseg - 1 ) { s_mid = nseg - 1; }
+      new_id [ j ] = k + s_mid;
+      for ( ; fill && s < nseg; s++ ) {
+	const double lo = ( x > el * s / nseg ) ? x : el * s / nseg, hi = ( x_end < el * ( s + 1 ) / nseg ) ? x_end : el * ( s + 1 ) / nseg;
+	const double share = ( e [ j ] > 0.0 ) ? ( ( hi > lo ) ? ( hi - lo ) / e [ j ] : 0.0 ) : 1.0;
+	const int q = w_offset + k + s;
+	w -> rad  [ q ] += share * ra [ j ] * len [ j ] / ( rad [ j ] * rad [ j ] * M_PI );
+	w -> len  [ q ] += share * len [ j ];
+	w -> area [ q ] += share * area [ j ];
+	w -> cm   [ q ] += share * cm [ j ];
+	w -> gl   [ q ] += share * gl [ j ];
+	w -> vl   [ q ] += share * gl [ j ] * vl [ j ];
+	if ( e [ j ] == 0.0 || x_end <= el * ( s + 1 ) / nseg ) { break; }
+      }
+      x = x_end;
+      if ( ! SECTION_CONTINUES ( j ) ) { tail [ j ] = k + nseg - 1; break; }
+    }
+    if ( fill ) {
+      for ( int s = 0; s < nseg; s++ ) {
+	const int q = w_offset + k + s;
+	w -> vl  [ q ] = ( w -> gl [ q ] > 0.0 ) ? w -> vl [ q ] / w -> gl [ q ] : vl [ i ];
+	w -> rad [ q ] = ( w -> rad [ q ] > 0.0 ) ? sqrt ( w -> ra [ q ] * w -> len [ q ] / ( M_PI * w -> rad [ q ] ) ) : rad [ i ];
+      }
+    }
+    k += nseg;
+  }
+#undef SECTION_CONTINUES
+
+  if ( fill ) {
+    int *cmap = &u -> cmap [ u -> swc_cid [ pid ] ];
+    for ( int j = 0; j < u -> swc_cid [ pid + 1 ] - u -> swc_cid [ pid ]; j++ ) { cmap [ j ] = new_id [ cmap [ j ] ]; }
+  }
+  free ( e );
+  free ( new_id );
+  free ( tail );
+  free ( next );
+  free ( n_child );
+  return k;
+}
+
 static void read_pas_file ( population_t *u, const int pid, const char *filename )
 {
   double _cm [ N_COMPTYPE ], _ra [ N_COMPTYPE ], _gl [ N_COMPTYPE ], _vl [ N_COMPTYPE ];
@@ -257,20 +426,11 @@ static void read_ion_file ( population_t *u, const int pid, const char *filename
     if ( nf == 22 ) {
       u -> gamma [ d_type + N_COMPTYPE * pid ] = f_gamma;
       u -> decay [ d_type + N_COMPTYPE * pid ] = f_decay;
+      for ( int i = 0; i < N_GBAR; i++ ) { u -> gdens [ i + N_GBAR * ( d_type + N_COMPTYPE * pid ) ] = f [ i ]; } // all-active: the conductance of a compartment is density * area
     }
-    if ( nf == 22 && ALLACTIVE == 1 ) {
-      const int n_comp = u -> n_comp [ pid ];
-      for ( int i = 0; i < n_comp; i++ ) {
-	const double area = u -> area [ u -> cid [ pid ] + i ];
-	for ( int j = 0; j < N_GBAR; j++ ) {
-	  u -> gbar [ j + N_GBAR * ( i + n_comp * pid ) ] = f [ j ] * area * 1e3; /* CONVERSION: 1e3 from S to mS */
-	}
-      }
-    } else { // Default is perisomatic
-      if ( d_type == SOMA ) {
-	const double area = u -> area [ u -> cid [ pid ] + 0 ]; // 0 == SOMA
-	for ( int i = 0; i < N_GBAR; i++ ) { u -> gbar [ i + N_GBAR * pid ] = f[i] * area * 1e3; /* CONVERSION: 1e3 from S to mS */ }
-      }
+    if ( d_type == SOMA ) { // Default is perisomatic
+      const double area = u -> area [ u -> cid [ pid ] + 0 ]; // 0 == SOMA
+      for ( int i = 0; i < N_GBAR; i++ ) { u -> gbar [ i + N_GBAR * pid ] = f[i] * area * 1e3; /* CONVERSION: 1e3 from S to mS */ }
     }
   }
   fclose ( file );
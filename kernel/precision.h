@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#pragma once
+
+#include "config.h"
+
+//
+// Storage types of the mixed-precision mode (MIXED_PRECISION in config.h).
+// Only the stored arrays change; arithmetic is done in double, and values are rounded when they are stored.
+//   state_t : ion gates, synaptic traces (sum0, sum1) and synaptic parameters (weight, and erev, decay, rise of the synapse types)
+//   matrix_t: Hines matrix and right-hand side (Ad, Api, b)
+// The membrane potential and [Ca2+] stay in double.
+//
+#if MIXED_PRECISION >= 1
+typedef float state_t;
+#else
+typedef double state_t;
+#endif
+
+#if MIXED_PRECISION >= 2
+typedef float matrix_t;
+#else
+typedef double matrix_t;
+#endif
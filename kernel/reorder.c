@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#include <stdlib.h>
+#include <assert.h>
+#include "neuron.h"
+#include "reorder.h"
+#include "config.h"
+
+static const int *sort_degree;
+static int compare_degree ( const void *a, const void *b )
+{
+  const int i = *( const int * ) a, j = *( const int * ) b;
+  const int di = sort_degree [ i ], dj = sort_degree [ j ];
+  return ( di != dj ) ? ( di > dj ) - ( di < dj ) : ( i > j ) - ( i < j );
+}
+
+//
+// Reverse Cuthill-McKee ordering of the connection graph (directions are ignored).
+// Connected neurons get close positions, so the targets of a spike are close in memory.
+// edge [ 2 * k ] and edge [ 2 * k + 1 ] are the pre and post neurons of the k-th connection.
+// Returns order [ position ] = neuron.
+//
+static int *rcm ( const int n_neuron, const long n_edge, const int *edge )
+{
+  int *degree = calloc ( n_neuron, sizeof ( int ) );
+  for ( long k = 0; k < n_edge; k++ ) {
+    const int a = edge [ 2 * k ], b = edge [ 2 * k + 1 ];
+    if ( a != b ) { degree [ a ]++; degree [ b ]++; }
+  }
+  long *ptr = calloc ( n_neuron + 1, sizeof ( long ) );
+  for ( int i = 0; i < n_neuron; i++ ) { ptr [ i + 1 ] = ptr [ i ] + degree [ i ]; }
+  int *adj = malloc ( ( ptr [ n_neuron ] ? ptr [ n_neuron ] : 1 ) * sizeof ( int ) );
+  {
+    long *pos = malloc ( ( n_neuron ? n_neuron : 1 ) * sizeof ( long ) );
+    for ( int i = 0; i < n_neuron; i++ ) { pos [ i ] = ptr [ i ]; }
+    for ( long k = 0; k < n_edge; k++ ) {
+      const int a = edge [ 2 * k ], b = edge [ 2 * k + 1 ];
+      if ( a != b ) { adj [ pos [ a ]++ ] = b; adj [ pos [ b ]++ ] = a; }
+    }
+    free ( pos );
+  }
+
+  // Neighbors and start neurons are visited in ascending degree
+  sort_degree = degree;
+  for ( int i = 0; i < n_neuron; i++ ) { qsort ( &adj [ ptr [ i ] ], ptr [ i + 1 ] - ptr [ i ], sizeof ( int ), compare_degree ); }
+  int *start = malloc ( ( n_neuron ? n_neuron : 1 ) * sizeof ( int ) );
+  for ( int i = 0; i < n_neuron; i++ ) { start [ i ] = i; }
+  qsort ( start, n_neuron, sizeof ( int ), compare_degree );
+
+  // Breadth-first search from each unvisited neuron of the lowest degree; order doubles as the queue
+  int *order = malloc ( ( n_neuron ? n_neuron : 1 ) * sizeof ( int ) );
+  char *visited = calloc ( n_neuron, sizeof ( char ) );
+  int head = 0, tail = 0;
+  for ( int s = 0; s < n_neuron; s++ ) {
+    if ( visited [ start [ s ] ] ) { continue; }
+    visited [ start [ s ] ] = 1;
+    order [ tail++ ] = start [ s ];
+    while ( head < tail ) {
+      const int v = order [ head++ ];
+      for ( long j = ptr [ v ]; j < ptr [ v + 1 ]; j++ ) {
+	if ( ! visited [ adj [ j ] ] ) { visited [ adj [ j ] ] = 1; order [ tail++ ] = adj [ j ]; }
+      }
+    }
+  }
+  assert ( tail == n_neuron );
+  for ( int i = 0; i < n_neuron / 2; i++ ) { const int t = order [ i ]; order [ i ] = order [ n_neuron - 1 - i ]; order [ n_neuron - 1 - i ] = t; }
+
+  free ( visited );
+  free ( start );
+  free ( adj );
+  free ( ptr );
+  free ( degree );
+  return order;
+}
+
+int *reorder_neurons ( const neuron_t *n, const long n_edge, const int *edge )
+{
+  int *new_id = calloc ( n -> n_neuron, sizeof ( int ) );
+  for ( int i = 0; i < n -> n_neuron; i++ ) { new_id [ i ] = i; }
+  if ( REORDER == 0 || n -> n_neuron == 0 ) { return new_id; }
+
+  int *order = rcm ( n -> n_neuron, n_edge, edge );
+
+  // Populations must stay contiguous, so neurons are renumbered within their own population in the RCM order
+  int *next = calloc ( n -> pid [ n -> n_neuron - 1 ] + 1, sizeof ( int ) ); // next [ pid ] == next free id in the population
+  for ( int i = n -> n_neuron - 1; i >= 0; i-- ) { next [ n -> pid [ i ] ] = i; }
+  for ( int k = 0; k < n -> n_neuron; k++ ) {
+    const int i = order [ k ];
+    new_id [ i ] = next [ n -> pid [ i ] ]++;
+  }
+  free ( next );
+  free ( order );
+
+  return new_id;
+}
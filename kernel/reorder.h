@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#pragma once
+
+#include "neuron.h"
+
+extern int *reorder_neurons ( const neuron_t *, const long, const int * ); // new_id [ id in the CSV files ] from the ( pre, post ) pairs of the connections; identity unless REORDER == 1
@@ -12,6 +12,7 @@
 #include "synapse.h"
 #include "solver.h"
 #include "hines.h"
+#include "timer.h"
 #include "config.h"
 //#include <omp.h>
 
@@ -25,16 +26,27 @@ solver_t *initialize_solver ( const population_t *u )
   int n_neuron = 0; for ( int i = 0; i < n_popl; i++ ) { n_neuron += u -> n_neuron [ i ]; }
   
   solver_t *solver = calloc ( 1, sizeof ( solver_t ) );
-  solver -> linsys = calloc ( n_neuron, sizeof ( linsys_t ) );
   solver -> n_popl = n_popl;
   solver -> n_neuron = n_neuron;
+  solver -> H = calloc ( n_popl, sizeof ( hines_matrix_t * ) );
+  solver -> Ad_axial = calloc ( u -> cid [ n_popl ], sizeof ( matrix_t ) );
+  solver -> Ad0      = calloc ( u -> cid [ n_popl ], sizeof ( matrix_t ) );
+
+  // Arena: linsys, then the hines_matrix_t, Ad and b of each neuron in the order of the neuron ids
+  size_t size = ARENA_SIZE ( n_neuron, sizeof ( linsys_t ) );
+  for ( int pid = 0; pid < n_popl; pid++ ) {
+    size += u -> n_neuron [ pid ] * ( ARENA_SIZE ( 1, sizeof ( hines_matrix_t ) ) + 2 * ARENA_SIZE ( u -> n_comp [ pid ], sizeof ( matrix_t ) ) );
+  }
+  solver -> arena = initialize_arena ( size );
+  solver -> linsys = arena_alloc ( solver -> arena, n_neuron, sizeof ( linsys_t ) );
 
   int offset = 0;
   for ( int pid = 0; pid < n_popl; pid++ ) {
     const int n_comp = u -> n_comp  [ pid ];
 
-    // Matrix
-    double *mat = calloc ( n_comp * n_comp, sizeof ( double ) );
+    // Matrix: the diagonal, and the (symmetric) entry of each compartment with its parent.
+    // Not dense (n_comp^2), since DLAMBDA can make the morphologies much finer than the SWC.
+    double *diag = calloc ( n_comp, sizeof ( double ) ), *off = calloc ( n_comp, sizeof ( double ) );
     {
       const int offset = u -> cid [ pid ];
       double *rad = &u -> rad [ offset ];
@@ -42,76 +54,110 @@ solver_t *initialize_solver ( const population_t *u )
       double *ra  = &u -> ra  [ offset ];
       int *parent = &u -> parent [ offset ];
 
-      for ( int i = 0; i < n_comp * n_comp; i++ ) { mat [ i ] = 0.0; }
+      // The parents precede their children, so each diagonal is summed in the order of the columns
       for ( int i = 0; i < n_comp; i++ ) {
 	const int d = parent [ i ];
 	if ( d >= 0 ) {
-	  double r = ( 2.0 / ( ( ra [ i ] * len [ i ] ) / ( rad [ i ] * rad [ i ] * M_PI ) + ( ra [ d ] * len [ d ] ) / ( rad [ d ] * rad [ d ] * M_PI ) ) ); // -1 * [mS]
-	  mat [ d + n_comp * i ] = r;
-	  mat [ i + n_comp * d ] = mat [ d + n_comp * i ]; // i*NGO -> set Rows, +d -> set Columns
+	  off [ i ] = ( 2.0 / ( ( ra [ i ] * len [ i ] ) / ( rad [ i ] * rad [ i ] * M_PI ) + ( ra [ d ] * len [ d ] ) / ( rad [ d ] * rad [ d ] * M_PI ) ) ); // -1 * [mS]
+	  diag [ i ] += off [ i ];
+	  diag [ d ] += off [ i ];
 	}
       }
+
+      // Constant part of the diagonal, shared by the neurons of the population: the axial conductances,
+      // and with cm / dt + g_leak for the step of the population (update_matrix halves the step)
+      const double *cm = &u -> cm [ offset ], *g_leak = &u -> gl [ offset ];
+      const double dt = 0.5 * u -> dt [ pid ];
       for ( int i = 0; i < n_comp; i++ ) {
-	double r = 0;
-	for ( int j = 0; j < n_comp; j++ ) {
-	  r += mat [ j + n_comp * i ];
-	}
-	mat [ i + n_comp * i ] = r;
+	solver -> Ad_axial [ offset + i ] = diag [ i ];
+	solver -> Ad0      [ offset + i ] = solver -> Ad_axial [ offset + i ] + ( ( cm [ i ] / dt ) + g_leak [ i ] );
       }
     }
 
+    // The morphology, Api and the partition are the same for all neurons of the population
+    hines_matrix_t *H = solver -> H [ pid ] = hines_matrix_initialize ( u, pid );
+    for ( int i = 0; i < n_comp; i++ ) {
+      const int parent_id = H -> parent_id [ i ];
+      H -> Ad  [ i ] = diag [ i ];
+      H -> Api [ i ] = ( parent_id >= 0 ) ? -off [ i ] : 0; // never modified by the solvers
+    }
+
+    // Ad and b of each neuron; this loop is the first touch of their pages, so it has to run on the thread
+    // that solves the neurons (solve_network is serial)
     for ( int li = 0; li < u -> n_neuron [ pid ]; li++ ) {
       linsys_t *s = &solver -> linsys [ offset + li ];
-      s -> H = hines_matrix_initialize( u, pid );
-      for ( int i = 0; i < n_comp; i++ ) {
-	const int parent_id = s -> H -> parent_id [ i ];
-	s -> H -> Ad     [ i ] = mat [ i + n_comp * i ];
-	s -> H -> Api    [ i ] = ( parent_id >= 0 ) ? -mat [ parent_id + n_comp * i ] : 0;
-	s -> H -> bu_Ad  [ i ] = mat [ i + n_comp * i ];
-	s -> H -> bu_Api [ i ] = ( parent_id >= 0 ) ? -mat [ parent_id + n_comp * i ] : 0;
-      }
-      s -> b = calloc ( n_comp, sizeof ( double ) ); // b value
+      s -> H = arena_alloc ( solver -> arena, 1, sizeof ( hines_matrix_t ) );
+      *s -> H = *H;
+      s -> H -> Ad = arena_alloc ( solver -> arena, n_comp, sizeof ( matrix_t ) );
+      s -> b       = arena_alloc ( solver -> arena, n_comp, sizeof ( matrix_t ) ); // b value
+      for ( int i = 0; i < n_comp; i++ ) { s -> H -> Ad [ i ] = H -> Ad [ i ]; s -> b [ i ] = 0.0; }
     }
 
     offset += u -> n_neuron [ pid ];
-    free ( mat );
+    free ( diag );
+    free ( off );
   }
 
   return solver;
 }
 
-static void update_matrix ( const int id, const population_t * __restrict__ u, const neuron_t * __restrict__ n, const ion_t * __restrict__ i, const conn_t * __restrict__ c, const synapse_t * __restrict__ s, linsys_t * __restrict__ linsys, const double dt )
+//
+// Assembly of the linear system of a neuron in one pass over the compartments and one over the synapses of each kind:
+// the diagonal starts from the precomputed Ad0 (Api is set once in initialize_solver), and each synapse
+// is decayed and stamped together. A dt other than the half step of the population (ADAPTIVE) is assembled
+// from Ad_axial, and the synapses are decayed by the corresponding power.
+//
+static void update_matrix ( const int id, const population_t * __restrict__ u, const neuron_t * __restrict__ n, const ion_t * __restrict__ i, const conn_t * __restrict__ c, synapse_t * __restrict__ s, const solver_t * __restrict__ solver, const double dt )
 {
   const int sid = n -> sid [ id ];
   const int pid = n -> pid [ id ];
+  const int cid = u -> cid [ pid ];
   const double *v      = &n -> v [ sid ];
-  const double *ca     = &n -> ca [ sid ];
   const double *i_ext  = &n -> i_ext [ sid ];
-  const double *cm     = &u -> cm [ u -> cid [ pid ] ];
-  const double *g_leak = &u -> gl [ u -> cid [ pid ] ];
-  const double *v_leak = &u -> vl [ u -> cid [ pid ] ];
+  const double *cm     = &u -> cm [ cid ];
+  const double *g_leak = &u -> gl [ cid ];
+  const double *v_leak = &u -> vl [ cid ];
+  const matrix_t *Ad0 = &solver -> Ad0 [ cid ], *Ad_axial = &solver -> Ad_axial [ cid ];
   const int n_comp = u -> n_comp [ pid ];
-
-  for ( int li = 0; li < linsys -> H -> n_comp; li++ ) { linsys -> H -> Ad [ li ] = linsys -> H -> bu_Ad [ li ]; linsys -> H  -> Api [ li ] = linsys -> H -> bu_Api[ li ]; }
+  const int own_dt = ( dt == 0.5 * u -> dt [ pid ] );
+  linsys_t *linsys = &solver -> linsys [ id ];
+  matrix_t *Ad = linsys -> H -> Ad, *b = linsys -> b;
 
   for ( int li = 0; li < n_comp; li++ ) {
-    linsys -> H -> Ad[ li ] += ( cm [ li ] / dt ) + g_leak [ li ];
-    linsys -> b [ li ]  = ( cm [ li ] / dt ) * v [ li ] + g_leak [ li ] * v_leak [ li ] + i_ext [ li ] * 1e-3; /* CONVERSION: 1e-3 from pA to nA */
+    Ad [ li ] = ( own_dt ) ? Ad0 [ li ] : Ad_axial [ li ] + ( ( cm [ li ] / dt ) + g_leak [ li ] );
+    b  [ li ] = ( cm [ li ] / dt ) * v [ li ] + g_leak [ li ] * v_leak [ li ] + i_ext [ li ] * 1e-3; /* CONVERSION: 1e-3 from pA to nA */
   }
   
-  double lhs = 0.0, rhs = 0.0;
-  calc_lhs_and_rhs ( u, n, i, pid, id, &lhs, &rhs );
-  linsys -> H -> Ad[ 0  ] += lhs;
-  linsys -> b [ 0  ] += rhs;
+  calc_lhs_and_rhs ( u, n, i, pid, id, Ad, b );
 
-  for ( int li = c -> ptr_post [ id ]; li < c -> ptr_post [ id + 1 ]; li++ ) {
+  const double ratio = 2.0 * dt / u -> dt [ pid ];
+  for ( long li = c -> ptr_post [ id ]; li < c -> ptr_post [ id + 1 ]; li++ ) { // double exponential
+    const int t = c -> type [ li ];
+    if ( own_dt ) { s -> sum0 [ li ] *= c -> decay [ t ]; s -> sum1 [ li ] *= c -> rise [ t ]; }
+    else { s -> sum0 [ li ] *= pow ( c -> decay [ t ], ratio ); s -> sum1 [ li ] *= pow ( c -> rise [ t ], ratio ); }
+    const int post_c    = c -> post_c [ li ];
+    const double weight = c -> weight [ li ];
+    const double erev   = c -> erev   [ t ];
+    const double sum0   = s -> sum0   [ li ];
+    const double sum1   = s -> sum1   [ li ];
+    const double g0 =   weight * sum0 * 1e-3; /* CONVERSION: 1e-3 from micro S to mS */
+    const double g1 = - weight * sum1 * 1e-3;
+    Ad [ post_c ] += g0;
+    b  [ post_c ] += g0 * erev;
+    Ad [ post_c ] += g1;
+    b  [ post_c ] += g1 * erev;
+  }
+  const long *ptr = &c -> ptr_post [ c -> n_post * SYN_SINGLE ];
+  for ( long li = ptr [ id ]; li < ptr [ id + 1 ]; li++ ) { // single exponential
+    const int t = c -> type [ li ];
+    if ( own_dt ) { s -> sum0 [ li ] *= c -> decay [ t ]; } else { s -> sum0 [ li ] *= pow ( c -> decay [ t ], ratio ); }
     const int post_c    = c -> post_c [ li ];
     const double weight = c -> weight [ li ];
-    const double erev   = c -> erev   [ li ];
+    const double erev   = c -> erev   [ t ];
     const double sum0   = s -> sum0   [ li ];
-    const double g = weight * sum0 * 1e-3; /* CONVERSION: 1e-3 from micro S to mS */
-    linsys -> H -> Ad [ post_c ] += g;
-    linsys -> b [ post_c ]       += g * erev;
+    const double g0 = weight * sum0 * 1e-3; /* CONVERSION: 1e-3 from micro S to mS */
+    Ad [ post_c ] += g0;
+    b  [ post_c ] += g0 * erev;
   }
 }
 
@@ -122,11 +168,11 @@ static void update_matrix ( const int id, const population_t * __restrict__ u, c
 static void solve_matrix ( linsys_t * __restrict__ l )
 {
   int n_comp = l -> H -> n_comp;
-  double *Ad = l -> H -> Ad;
-  double *Api = l -> H -> Api;
+  matrix_t *Ad = l -> H -> Ad;
+  matrix_t *Api = l -> H -> Api;
   int *parent_id = l -> H -> parent_id;
-  double *b = l -> b;
-  double *x = l -> b;
+  matrix_t *b = l -> b;
+  matrix_t *x = l -> b;
    
   // TRIANG
   int pid = parent_id [ n_comp - 1 ];
@@ -164,6 +210,54 @@ static void solve_matrix ( linsys_t * __restrict__ l )
   }
 }
 
+//
+// Multisplit version of "solve_matrix" (MULTISPLIT > 1; see hines_matrix_split in hines.c).
+// The parts are eliminated by different threads; each compartment still receives the updates from its children
+// in descending order, so the result is bitwise identical to the serial solvers.
+//
+static void solve_matrix_multisplit ( linsys_t * __restrict__ l )
+{
+  const hines_matrix_t *H = l -> H;
+  matrix_t *Ad = H -> Ad;
+  const matrix_t *Api = H -> Api;
+  const int *parent_id = H -> parent_id;
+  matrix_t *b = l -> b;
+  matrix_t *x = l -> b;
+
+  // TRIANG
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( static, 1 )
+#endif
+  for ( int k = 0; k < H -> n_part; k++ ) {
+    for ( int j = H -> part_ptr [ k + 1 ] - 1; j >= H -> part_ptr [ k ]; j-- ) {
+      const int i = H -> part_node [ j ], pid = parent_id [ i ];
+      Ad [ pid ] -= Api [ i ] * Api [ i ] / Ad [ i ];
+      b  [ pid ] -= b   [ i ] * Api [ i ] / Ad [ i ];
+    }
+  }
+  for ( int j = H -> n_root - 1; j >= 0; j-- ) {
+    const int i = H -> root_node [ j ], pid = parent_id [ i ];
+    Ad [ pid ] -= Api [ i ] * Api [ i ] / Ad [ i ];
+    b  [ pid ] -= b   [ i ] * Api [ i ] / Ad [ i ];
+  }
+
+  // FWSUB
+  x [ 0 ] = b [ 0 ] / Ad [ 0 ];
+  for ( int j = 0; j < H -> n_root; j++ ) {
+    const int i = H -> root_node [ j ];
+    x [ i ] = ( b [ i ] - x [ parent_id [ i ] ] * Api [ i ] ) / Ad [ i ];
+  }
+#ifdef _OPENMP
+#pragma omp parallel for schedule ( static, 1 )
+#endif
+  for ( int k = 0; k < H -> n_part; k++ ) {
+    for ( int j = H -> part_ptr [ k ]; j < H -> part_ptr [ k + 1 ]; j++ ) {
+      const int i = H -> part_node [ j ];
+      x [ i ] = ( b [ i ] - x [ parent_id [ i ] ] * Api [ i ] ) / Ad [ i ];
+    }
+  }
+}
+
 /*
 //
 // The following is the vanilla version of "solve_matrix". We do not use this.
@@ -193,30 +287,50 @@ static void solve_matrix_vanilla ( linsys_t * __restrict__ l )
 }
 */
 
-void solve ( const int id, const population_t * __restrict__ u, neuron_t * __restrict__ n, ion_t * __restrict__ i, const conn_t * __restrict__ c, synapse_t * __restrict__ s, solver_t * __restrict__ solver )
+static void solve_linsys ( linsys_t * __restrict__ l )
+{
+  if ( l -> H -> n_part > 0 ) { solve_matrix_multisplit ( l ); }
+  else if ( l -> H -> solve != NULL ) { l -> H -> solve ( l -> H -> Ad, l -> H -> Api, l -> b ); } // hines_gen.h
+  else { solve_matrix ( l ); }
+}
+
+void solve_step ( const int id, const population_t * __restrict__ u, neuron_t * __restrict__ n, ion_t * __restrict__ i, const conn_t * __restrict__ c, synapse_t * __restrict__ s, solver_t * __restrict__ solver, const double dt )
 {
   const int sid = n -> sid [ id ];
   const int pid = n -> pid [ id ];
   const int n_comp = u -> n_comp [ pid ];
   linsys_t *linsys = &solver -> linsys [ id ];
 
-  update_synapse ( id, c, s );
-  update_matrix ( id, u, n, i, c, s, linsys, 0.5*DT );
-  solve_matrix ( linsys );
-  update_ca ( id, u, i, n, 0.5*DT );
-  update_ion ( id, n, linsys -> b, i, DT );
-  update_ca ( id, u, i, n, 0.5*DT );
+  TIMER_BEGIN ( t1 );
+  update_matrix ( id, u, n, i, c, s, solver, 0.5 * dt ); // with update_synapse
+  TIMER_END ( t1, T_MATRIX, pid );
+  TIMER_BEGIN ( t2 );
+  solve_linsys ( linsys );
+  TIMER_END ( t2, T_SOLVE, pid );
+  TIMER_BEGIN ( t3 );
+  update_ca ( id, u, i, n, 0.5 * dt );
+  update_ion ( id, u, n, linsys -> b, i, dt );
+  update_ca ( id, u, i, n, 0.5 * dt );
+  TIMER_END ( t3, T_ION, pid );
+  TIMER_BEGIN ( t4 );
   for ( int j = 0; j < n_comp; j++ ) { n -> v [ sid + j ] = 2 * linsys -> b [ j ] - n -> v [ sid + j ]; }
+  TIMER_END ( t4, T_SOLVE, pid );
+}
+
+void solve ( const int id, const population_t * __restrict__ u, neuron_t * __restrict__ n, ion_t * __restrict__ i, const conn_t * __restrict__ c, synapse_t * __restrict__ s, solver_t * __restrict__ solver )
+{
+  solve_step ( id, u, n, i, c, s, solver, u -> dt [ n -> pid [ id ] ] );
 }
 
 void finalize_solver ( solver_t *solver )
 {
-  for ( int i = 0; i < solver -> n_neuron; i++ ) {
-    linsys_t *s = &solver -> linsys [ i ];
-    hines_matrix_finalize ( s -> H );
-    free ( s -> H );
-    free ( s -> b );
+  for ( int pid = 0; pid < solver -> n_popl; pid++ ) {
+    hines_matrix_finalize ( solver -> H [ pid ] );
+    free ( solver -> H [ pid ] );
   }
-  free ( solver -> linsys );
+  free ( solver -> H );
+  finalize_arena ( solver -> arena ); // linsys, and Ad and b of the neurons
+  free ( solver -> Ad_axial );
+  free ( solver -> Ad0 );
   free ( solver );
 }
@@ -8,17 +8,22 @@
 #include "conn.h"
 #include "synapse.h"
 #include "hines.h"
+#include "arena.h"
 
 typedef struct {
   hines_matrix_t *H;
-  double *b;
+  matrix_t *b;
 } linsys_t;
 
 typedef struct {
   linsys_t *linsys;
+  hines_matrix_t **H; // size == # populations; parent_id, Api and the partition, shared by the linsys -> H of the neurons of the population
+  arena_t *arena;     // linsys, and per neuron linsys -> H, its Ad and b
+  matrix_t *Ad_axial, *Ad0; // size == # compartments of all populations (cid); diagonal of the axial conductances, and with cm / dt + g_leak for the half step of the population
   int n_popl, n_neuron;
 } solver_t;
 
 extern solver_t *initialize_solver ( const population_t * );
 extern void solve ( const int, const population_t *, neuron_t *, ion_t *, const conn_t *, synapse_t *, solver_t *solver );
+extern void solve_step ( const int, const population_t *, neuron_t *, ion_t *, const conn_t *, synapse_t *, solver_t *solver, const double ); // with a given dt
 extern void finalize_solver ( solver_t * );
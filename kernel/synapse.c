@@ -15,7 +15,8 @@ synapse_t *initialize_synapse ( conn_t *c )
 
   if ( c -> n_conn == 0 ) { return s; }
 
-  s -> sum0   = calloc ( c -> n_conn, sizeof ( double ) );
+  s -> sum0   = calloc ( c -> n_conn, sizeof ( state_t ) );
+  s -> sum1   = calloc ( ( c -> n_double > 0 ) ? c -> n_double : 1, sizeof ( state_t ) ); // double-exponential connections only
   s -> delay  = calloc ( c -> n_conn, sizeof ( int ) );
   return s;
 }
@@ -23,19 +24,28 @@ synapse_t *initialize_synapse ( conn_t *c )
 void finalize_synapse ( synapse_t *s )
 {
   if ( s -> sum0  != NULL ) { free ( s -> sum0  ); }
+  if ( s -> sum1  != NULL ) { free ( s -> sum1  ); }
   if ( s -> delay != NULL ) { free ( s -> delay ); }
   free ( s );
 }
 
 void update_synapse ( const int id, const conn_t * __restrict__ c, synapse_t * __restrict__ s )
 {
-  for ( int i = c -> ptr_post [ id ]; i < c -> ptr_post [ id + 1 ]; i++ ) { s -> sum0 [ i ] *= c -> decay [ i ]; }
+  const long *ptr = &c -> ptr_post [ c -> n_post * SYN_SINGLE ];
+  for ( long i = c -> ptr_post [ id ]; i < c -> ptr_post [ id + 1 ]; i++ ) { s -> sum0 [ i ] *= c -> decay [ c -> type [ i ] ]; s -> sum1 [ i ] *= c -> rise [ c -> type [ i ] ]; }
+  for ( long i = ptr [ id ]; i < ptr [ id + 1 ]; i++ ) { s -> sum0 [ i ] *= c -> decay [ c -> type [ i ] ]; }
 }
 
 void add_spike_to_synapse_per_ms ( const conn_t * __restrict__ c, synapse_t * __restrict__ s ) // each 1 ms
 {
-  for ( int i = 0; i < c -> n_conn; i++ ) {
-    s -> sum0 [ i ] += ( s -> delay [ i ] == 1 ) ? 1 : 0;
+  for ( long i = 0; i < c -> n_double; i++ ) {
+    const int arrived = ( s -> delay [ i ] == 1 );
+    s -> sum0 [ i ] += arrived;
+    s -> sum1 [ i ] += arrived;
+    s -> delay [ i ] >>= 1;
+  }
+  for ( long i = c -> n_double; i < c -> n_conn; i++ ) {
+    s -> sum0 [ i ] += ( s -> delay [ i ] == 1 );
     s -> delay [ i ] >>= 1;
   }
 }
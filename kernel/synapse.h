@@ -3,12 +3,15 @@
 
 #pragma once
 
+#include "conn.h"
+#include "precision.h"
+
 typedef struct {
-  double *sum0;
+  state_t *sum0, *sum1; // decay trace of each connection, and rise trace of each double-exponential one (size == n_double)
   int *delay;
 } synapse_t;
 
 extern synapse_t *initialize_synapse ( conn_t * );
-extern void update_synapse ( const int, const conn_t *, synapse_t * );
+extern void update_synapse ( const int, const conn_t *, synapse_t * ); // decay only; solved neurons decay in update_matrix (solver.c)
 extern void add_spike_to_synapse_per_ms ( const conn_t *, synapse_t * ); // each 1 ms
 extern void finalize_synapse ( synapse_t * );
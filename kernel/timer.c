@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2026 Neulite Core Team <neulite-core@numericalbrain.org>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "popl.h"
+#include "timer.h"
+#include "config.h"
+
+static const char *phase_name [ N_TIMER ] = { "update_synapse", "update_matrix", "solve_matrix", "update_ion_ca", "spike_detection", "spike_propagation", "output" };
+
+//
+// acc [ thread ][ phase ][ pid + 1 ]; slot 0 is for time that belongs to no population.
+// Each thread has its own row, so timer_add needs no synchronization.
+//
+static double *acc = NULL;
+static int n_thread = 1, n_slot = 1;
+static const population_t *popl = NULL;
+static double progress_start = 0.0, progress_last = 0.0;
+
+double timer_now ( void )
+{
+  struct timespec ts;
+  clock_gettime ( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec + ( double ) ts.tv_nsec * 1.0e-9;
+}
+
+void timer_initialize ( const population_t *u )
+{
+#ifdef _OPENMP
+  n_thread = omp_get_max_threads ( );
+#endif
+  popl = u;
+  n_slot = u -> n_popl + 1;
+  acc = calloc ( n_thread * N_TIMER * n_slot, sizeof ( double ) );
+  progress_start = progress_last = timer_now ( );
+}
+
+void timer_add ( const int phase, const int pid, const double sec )
+{
+#ifdef _OPENMP
+  const int thread = omp_get_thread_num ( );
+#else
+  const int thread = 0;
+#endif
+  acc [ ( pid + 1 ) + n_slot * ( phase + N_TIMER * thread ) ] += sec;
+}
+
+void timer_progress ( const int t_ms )
+{
+  const double now = timer_now ( );
+  if ( t_ms > 0 && now - progress_last < PROGRESS_INTERVAL ) { return; }
+  fprintf ( stderr, "t = %d ms (%.2f ms/s)\n", t_ms, ( now > progress_start ) ? t_ms / ( now - progress_start ) : 0.0 );
+  progress_last = now;
+}
+
+void timer_finalize ( const double elapsed )
+{
+  if ( PROFILE == 1 ) {
+    // Sum over threads; phase [ N_TIMER ][ n_slot ]
+    double *phase = calloc ( N_TIMER * n_slot, sizeof ( double ) );
+    for ( int t = 0; t < n_thread; t++ ) {
+      for ( int k = 0; k < N_TIMER * n_slot; k++ ) { phase [ k ] += acc [ k + N_TIMER * n_slot * t ]; }
+    }
+    // spike_detection is measured as the whole loop over a neuron; the phases inside solve are subtracted
+    for ( int p = 0; p < n_slot; p++ ) {
+      for ( int k = T_SYNAPSE; k <= T_ION; k++ ) { phase [ p + n_slot * T_SPIKE ] -= phase [ p + n_slot * k ]; }
+      if ( phase [ p + n_slot * T_SPIKE ] < 0.0 ) { phase [ p + n_slot * T_SPIKE ] = 0.0; }
+    }
+    double total [ N_TIMER ];
+    for ( int k = 0; k < N_TIMER; k++ ) {
+      total [ k ] = 0.0;
+      for ( int p = 0; p < n_slot; p++ ) { total [ k ] += phase [ p + n_slot * k ]; }
+    }
+
+    fprintf ( stderr, "%-18s %12s %7s\n", "phase", "time [s]", "[%]" );
+    for ( int k = 0; k < N_TIMER; k++ ) {
+      fprintf ( stderr, "%-18s %12.3f %7.2f\n", phase_name [ k ], total [ k ], ( elapsed > 0.0 ) ? 100.0 * total [ k ] / ( elapsed * n_thread ) : 0.0 );
+    }
+
+    FILE *file = fopen ( "profile.json", "w" );
+    if ( ! file ) { fprintf ( stderr, "Error: cannot open profile.json\n" ); exit ( 1 ); }
+    fprintf ( file, "{\n  \"tstop\": %f,\n  \"dt\": %f,\n  \"threads\": %d,\n  \"elapsed\": %f,\n", ( double ) TSTOP, DT, n_thread, elapsed );
+    fprintf ( file, "  \"phases\": {" );
+    for ( int k = 0; k < N_TIMER; k++ ) { fprintf ( file, "%s\"%s\": %f", ( k == 0 ) ? " " : ", ", phase_name [ k ], total [ k ] ); }
+    fprintf ( file, " },\n  \"populations\": [\n" );
+    for ( int pid = 0; pid < popl -> n_popl; pid++ ) {
+      fprintf ( file, "    { \"pid\": %d, \"n_neuron\": %d, \"n_comp\": %d, \"phases\": {", pid, popl -> n_neuron [ pid ], popl -> n_comp [ pid ] );
+      for ( int k = 0; k < N_TIMER; k++ ) { fprintf ( file, "%s\"%s\": %f", ( k == 0 ) ? " " : ", ", phase_name [ k ], phase [ ( pid + 1 ) + n_slot * k ] ); }
+      fprintf ( file, " } }%s\n", ( pid == popl -> n_popl - 1 ) ? "" : "," );
+    }
+    fprintf ( file, "  ]\n}\n" );
+    fclose ( file );
+    free ( phase );
+  }
+  free ( acc );
+  acc = NULL;
+}
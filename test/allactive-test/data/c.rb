@@ -0,0 +1,20 @@
+#!/usr/bin/ruby
+# Connections of test/allactive-test onto random compartments: ruby data/c.rb > c.csv
+
+srand(1)
+N = 6
+E = 4
+N_COMP = [3682] * E + [1900] * (N - E)
+
+puts "#pre,post_i,post_c,weight,decay,rise,erev,delay,e/i"
+
+N.times{|i|
+  N.times{|j|
+    weight = if i < E then 0.5e-3 else 1.0e-3 end
+    tau_decay = if i < E then 5 else 10 end
+    tau_rise = 1
+    erev = if i < E then 0.0 else -70.0 end
+    ei = if i < E then 'e' else 'i' end
+    puts "#{i},#{j},#{rand(N_COMP[j])},#{weight},#{tau_decay},#{tau_rise},#{erev},#{1 + rand(3)},#{ei}" if rand < 0.5
+  }
+}
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+Benchmark runner
+
+Builds nl from a kernel or flavor directory, runs it on synthetic networks
+(gen_network.py) at several scales and thread or rank counts, and appends one
+JSON record per run to a results file, so that versions can be compared.
+
+Each record has the parameters of the run, the elapsed time of the time loop
+as reported by nl, and the throughput:
+  neuron_ms_per_s       simulated neuron-milliseconds per second
+  comp_updates_per_s    compartment updates (one per compartment and DT) per second
+
+Thread counts are set with OMP_NUM_THREADS; an OpenMP Makefile is used when
+any count is above 1. Only the MPI flavors run their neurons in parallel threads,
+so counts above 1 are rejected for the kernel, whose timings would not change.
+Rank counts run nl with mpirun and also need an MPI flavor.
+
+Usage:
+    python bench.py [--src ../../kernel] [--cells 160,640,2560] [--threads 1,2,4]
+                    [--ranks 1,2] [--fanin 100] [--delay fixed:1] [--regime asynchronous]
+                    [--tstop 100] [--results results.jsonl]
+"""
+import sys
+import os
+import re
+import json
+import shutil
+import socket
+import argparse
+import subprocess
+import datetime
+
+from gen_network import generate, REGIME
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def int_list(s):
+    return [int(x) for x in s.split(',') if x]
+
+
+def is_mpi_flavor(src):
+    with open(os.path.join(src, 'network.c')) as f:
+        return '#include <mpi.h>' in f.read()
+
+
+def build(src, builddir, makefile, config):
+    """Copy src to builddir, override config.h and build nl."""
+    if os.path.exists(builddir):
+        shutil.rmtree(builddir)
+    shutil.copytree(src, builddir)
+    subprocess.run(['make', 'clean'], cwd=builddir, stdout=subprocess.DEVNULL, check=True)
+    path = os.path.join(builddir, 'config.h')
+    if not os.path.exists(path):
+        shutil.copy(os.path.join(builddir, 'config.h.dummy'), path)
+    with open(path) as f:
+        text = f.read()
+    for key, value in config.items():
+        text, n = re.subn(rf'#define {key} \( [^)]* \)', f'#define {key} ( {value} )', text)
+        if n != 1:
+            print(f"Error: {key} is not in {path}")
+            sys.exit(1)
+    with open(path, 'w') as f:
+        f.write(text)
+    r = subprocess.run(['make', '-f', makefile], cwd=builddir, capture_output=True, text=True)
+    if r.returncode != 0:
+        print(r.stdout + r.stderr)
+        sys.exit(1)
+    return os.path.join(builddir, 'nl')
+
+
+def run(nl, netdir, threads, ranks, mpirun):
+    for f in os.listdir(netdir):
+        if re.fullmatch(r'[vs]\d*\.(dat|bin)', f):
+            os.remove(os.path.join(netdir, f))
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    cmd = [nl, 'p.csv', 'c.csv']
+    if ranks is not None:
+        cmd = mpirun.split() + ['-np', str(ranks)] + cmd
+    r = subprocess.run(cmd, cwd=netdir, env=env, capture_output=True, text=True)
+    m = re.search(r'Elapsed time = ([0-9.eE+-]+) sec', r.stderr)
+    if r.returncode != 0 or not m:
+        print(r.stderr[-2000:])
+        print(f"Error: {' '.join(cmd)} failed")
+        sys.exit(1)
+    n_spikes = 0
+    for f in os.listdir(netdir):
+        if re.fullmatch(r's\d*\.dat', f):
+            with open(os.path.join(netdir, f)) as s:
+                n_spikes += sum(1 for _ in s)
+    return float(m.group(1)), n_spikes
+
+
+def git_version():
+    try:
+        return subprocess.run(['git', 'describe', '--always', '--dirty'], cwd=HERE,
+                              capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Neulite benchmark runner")
+    parser.add_argument('--src', default=os.path.join(HERE, '..', '..', 'kernel'))
+    parser.add_argument('--makefile', default=None, help="default: Makefile, or Makefiles/Makefile.linuxomp for threads > 1")
+    parser.add_argument('--cells', type=int_list, default=[160, 640, 2560])
+    parser.add_argument('--threads', type=int_list, default=[1])
+    parser.add_argument('--ranks', type=int_list, default=None)
+    parser.add_argument('--mpirun', default='mpirun')
+    parser.add_argument('--fanin', type=int, default=100)
+    parser.add_argument('--delay', default='fixed:1')
+    parser.add_argument('--regime', default='asynchronous', choices=list(REGIME))
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--tstop', type=float, default=100.0)
+    parser.add_argument('--dt', type=float, default=0.1)
+    parser.add_argument('--workdir', default=os.path.join(HERE, 'work'))
+    parser.add_argument('--results', default=os.path.join(HERE, 'results.jsonl'))
+    args = parser.parse_args()
+
+    src = os.path.abspath(args.src)
+    if not is_mpi_flavor(src) and (max(args.threads) > 1 or args.ranks):
+        print(f"Error: {src} is not an MPI flavor; --threads above 1 and --ranks need one, e.g. --src ../../flavors/mpi")
+        sys.exit(1)
+    makefile = args.makefile or ('Makefile' if max(args.threads) == 1 else 'Makefiles/Makefile.linuxomp')
+    i_amp = REGIME[args.regime][2]
+    config = {'TSTOP': args.tstop, 'DT': args.dt, 'I_AMP': i_amp, 'I_DELAY': 0.0, 'I_DURATION': args.tstop}
+    nl = build(src, os.path.join(args.workdir, 'build'), makefile, config)
+
+    version, host = git_version(), socket.gethostname()
+    for n_cells in args.cells:
+        netdir = os.path.join(args.workdir, f'net{n_cells}')
+        n_comp, n_conn = generate(netdir, n_cells, min(args.fanin, n_cells), args.delay, args.regime, args.seed)
+        for ranks in (args.ranks or [None]):
+            for threads in args.threads:
+                elapsed, n_spikes = run(nl, netdir, threads, ranks, args.mpirun)
+                record = {
+                    'date': datetime.datetime.now().isoformat(timespec='seconds'),
+                    'version': version, 'host': host, 'src': os.path.relpath(src, os.path.join(HERE, '..', '..')),
+                    'cells': n_cells, 'compartments': n_comp, 'connections': n_conn,
+                    'fanin': min(args.fanin, n_cells), 'delay': args.delay, 'regime': args.regime, 'seed': args.seed,
+                    'tstop': args.tstop, 'dt': args.dt, 'threads': threads, 'ranks': ranks or 1,
+                    'elapsed': elapsed, 'spikes': n_spikes,
+                    'neuron_ms_per_s': n_cells * args.tstop / elapsed,
+                    'comp_updates_per_s': n_comp * round(args.tstop / args.dt) / elapsed,
+                }
+                with open(args.results, 'a') as f:
+                    f.write(json.dumps(record) + '\n')
+                print(f"cells {n_cells:7d} ranks {ranks or 1:3d} threads {threads:3d}: {elapsed:10.3f} s, "
+                      f"{record['neuron_ms_per_s']:12.1f} neuron-ms/s, {record['comp_updates_per_s']:.3e} comp-updates/s, "
+                      f"{n_spikes} spikes")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Synthetic network generator for benchmarks
+
+Writes p.csv and c.csv for a network of a given size, built from the cells
+of test/kernel-test: 80 % excitatory Scnn1a cells and 20 % inhibitory PV cells,
+in the same layout as test/kernel-test/data/c.rb.
+
+  --cells N        number of cells
+  --fanin K        number of presynaptic cells of each cell (drawn without replacement)
+  --delay D        fixed:D, uniform:A:B or exp:MEAN [ms]; clipped to [1, 30]
+  --regime R       firing regime, see REGIME below
+  --seed S         random seed
+
+The regime scales the synaptic weights; the current injection that goes with
+it is applied by bench.py at build time (I_AMP, I_DELAY and I_DURATION).
+
+Usage:
+    python gen_network.py --cells 1000 --fanin 100 --delay uniform:1:5 --regime asynchronous outdir
+"""
+import sys
+import os
+import argparse
+import random
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'kernel-test', 'data')
+
+# name, swc file, ion file, fraction of cells, excitatory
+CELLS = [
+    ('Scnn1a', 'Scnn1a_473845048_m_c.swc', '472363762.csv', 0.8, True),
+    ('PV', 'Pvalb_470522102_m_c.swc', '472912177.csv', 0.2, False),
+]
+
+# weight scale of excitatory and inhibitory synapses, injected current [nA] (0 == none)
+REGIME = {
+    'quiet': (0.1, 1.0, 0.0),          # subthreshold; only the cells themselves are computed
+    'asynchronous': (1.0, 1.0, 0.12),  # the drive of test/kernel-test
+    'synchronous': (3.0, 0.25, 0.12),  # strong recurrent excitation, population bursts
+}
+
+MAX_DELAY = 30  # delays are kept as a bit mask in an int
+
+
+def count_compartments(swc):
+    n = 0
+    with open(swc) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if line:
+                n += 1
+    return n
+
+
+def delay_sampler(spec):
+    kind, *arg = spec.split(':')
+    if kind == 'fixed' and len(arg) == 1:
+        d = int(arg[0])
+        draw = lambda r: d
+    elif kind == 'uniform' and len(arg) == 2:
+        a, b = int(arg[0]), int(arg[1])
+        draw = lambda r: r.randint(a, b)
+    elif kind == 'exp' and len(arg) == 1:
+        mean = float(arg[0])
+        draw = lambda r: 1 + int(r.expovariate(1.0 / mean))
+    else:
+        print(f"Error: unknown delay distribution {spec}")
+        sys.exit(1)
+    return lambda r: min(max(draw(r), 1), MAX_DELAY)
+
+
+def generate(outdir, n_cells, fanin, delay, regime, seed):
+    if regime not in REGIME:
+        print(f"Error: unknown regime {regime}; choose from {', '.join(REGIME)}")
+        sys.exit(1)
+    if not 0 <= fanin <= n_cells:
+        print(f"Error: fan-in {fanin} must be in [0, {n_cells}]")
+        sys.exit(1)
+    w_e, w_i, _ = REGIME[regime]
+    draw_delay = delay_sampler(delay)
+    rng = random.Random(seed)
+    os.makedirs(outdir, exist_ok=True)
+
+    counts = [int(round(n_cells * frac)) for _, _, _, frac, _ in CELLS]
+    counts[0] = n_cells - sum(counts[1:])
+    n_exc = counts[0]
+
+    n_comp_total = 0
+    with open(os.path.join(outdir, 'p.csv'), 'w') as f:
+        f.write("# n_cell, n_comp, name, swc_file, ion_file\n")
+        for (name, swc, ion, _, _), n in zip(CELLS, counts):
+            if n == 0:
+                continue
+            swc_path = os.path.abspath(os.path.join(DATA, swc))
+            ion_path = os.path.abspath(os.path.join(DATA, ion))
+            n_comp = count_compartments(os.path.join(DATA, swc))
+            n_comp_total += n * n_comp
+            f.write(f"{n}, {n_comp}, {name}, {swc_path}, {ion_path}\n")
+
+    # Draw the presynaptic cells of each cell, then write the connections in the order of the presynaptic cells
+    pre_of = [[] for _ in range(n_cells)]
+    for post in range(n_cells):
+        for pre in rng.sample(range(n_cells), fanin):
+            pre_of[pre].append((post, draw_delay(rng)))
+
+    n_conn = 0
+    with open(os.path.join(outdir, 'c.csv'), 'w') as f:
+        f.write("#pre,post_i,post_c,weight,decay,rise,erev,delay,e/i\n")
+        for pre in range(n_cells):
+            if pre < n_exc:
+                weight, decay, erev, ei = 0.1e-3 * w_e, 5, 0.0, 'e'
+            else:
+                weight, decay, erev, ei = 0.4e-3 * w_i, 10, -70.0, 'i'
+            for post, d in sorted(pre_of[pre]):
+                f.write(f"{pre},{post},0,{weight:g},{decay},1,{erev},{d},{ei}\n")
+                n_conn += 1
+
+    return n_comp_total, n_conn
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Synthetic network generator for benchmarks")
+    parser.add_argument('--cells', type=int, default=160)
+    parser.add_argument('--fanin', type=int, default=3)
+    parser.add_argument('--delay', default='fixed:1')
+    parser.add_argument('--regime', default='asynchronous', choices=list(REGIME))
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('outdir')
+    args = parser.parse_args()
+
+    n_comp, n_conn = generate(args.outdir, args.cells, args.fanin, args.delay, args.regime, args.seed)
+    print(f"{args.outdir}: {args.cells} cells, {n_comp} compartments, {n_conn} connections")
+
+
+if __name__ == "__main__":
+    main()
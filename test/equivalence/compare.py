@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+Output comparison for numerical equivalence
+
+Compares the outputs of a candidate run with those of a reference run and
+fails (exit code 1) when they differ by more than the tolerances.
+
+Each directory holds the outputs of one run, in any of the formats of the kernels:
+  v.dat and s.dat (kernel), v%d.dat and s%d.dat (MPI flavors, one per rank,
+  concatenated in rank order), or v.bin and s.bin (MERGED_OUTPUT).
+
+Membrane potentials:
+  v_rms        RMS error over all cells and steps [mV]
+  v_rms_cell   largest RMS error of a single cell [mV]
+  v_max        largest absolute error [mV]
+Spikes, per cell:
+  van Rossum   distance with an exponential kernel of time constant --tau [ms],
+               normalized so that one unmatched spike gives sqrt(1/2)
+  coincidence  coincidence factor of Kistler et al. (1997) with window --window [ms];
+               1 == identical, 0 == chance level
+Spikes, all cells:
+  rate error   relative difference of the number of spikes
+
+Usage:
+    python compare.py [--max-v-rms 1.0] [--max-van-rossum 1.0] [--min-coincidence 0.9] [--max-rate-error 0.1]
+                      [--ref-stride 1] ref_dir cand_dir
+"""
+import sys
+import os
+import glob
+import math
+import struct
+import argparse
+import itertools
+from array import array
+
+HEADER = struct.Struct('=8siid')  # see helper/merged_output.py
+
+
+def rank_files(d, prefix, ext):
+    files = glob.glob(os.path.join(d, f'{prefix}[0-9]*.{ext}'))
+    return sorted(files, key=lambda f: int(os.path.basename(f)[len(prefix):-len(ext) - 1]))
+
+
+def voltage_rows(d):
+    """Yield (t, [v of each cell]) for each step."""
+    if os.path.exists(os.path.join(d, 'v.bin')):
+        with open(os.path.join(d, 'v.bin'), 'rb') as f:
+            _, n_neurons, _, dt = HEADER.unpack(f.read(HEADER.size))
+            step = 0
+            while True:
+                row = array('d')
+                try:
+                    row.fromfile(f, n_neurons)
+                except EOFError:
+                    return
+                yield step * dt, list(row)
+                step += 1
+    files = [os.path.join(d, 'v.dat')] if os.path.exists(os.path.join(d, 'v.dat')) else rank_files(d, 'v', 'dat')
+    if not files:
+        print(f"Error: no v.dat, v%d.dat or v.bin in {d}")
+        sys.exit(1)
+    handles = [open(f) for f in files]
+    try:
+        for lines in zip(*handles):
+            row = []
+            for line in lines:
+                row.extend(float(x) for x in line.split()[1:])
+            yield float(lines[0].split()[0]), row
+    finally:
+        for h in handles:
+            h.close()
+
+
+def spike_trains(d):
+    """Return { cell: [spike times] }."""
+    trains = {}
+    if os.path.exists(os.path.join(d, 's.bin')):
+        with open(os.path.join(d, 's.bin'), 'rb') as f:
+            f.read(HEADER.size)
+            pairs = array('i')
+            pairs.frombytes(f.read())
+            spikes = zip(pairs[0::2], pairs[1::2])
+    else:
+        files = [os.path.join(d, 's.dat')] if os.path.exists(os.path.join(d, 's.dat')) else rank_files(d, 's', 'dat')
+        if not files:
+            print(f"Error: no s.dat, s%d.dat or s.bin in {d}")
+            sys.exit(1)
+        spikes = []
+        for name in files:
+            with open(name) as f:
+                spikes.extend((float(t), int(i)) for t, i in (line.split() for line in f if line.strip()))
+    for t, i in spikes:
+        trains.setdefault(i, []).append(float(t))
+    for t in trains.values():
+        t.sort()
+    return trains
+
+
+def van_rossum(a, b, tau):
+    def k(x, y):
+        return sum(math.exp(-abs(s - t) / tau) for s in x for t in y)
+    return math.sqrt(max(0.5 * (k(a, a) + k(b, b) - 2.0 * k(a, b)), 0.0))
+
+
+def coincidence(ref, cand, window, duration):
+    if not ref and not cand:
+        return 1.0
+    n_coinc, j = 0, 0
+    for t in ref:  # each candidate spike matches at most one reference spike
+        while j < len(cand) and cand[j] < t - window:
+            j += 1
+        if j < len(cand) and cand[j] <= t + window:
+            n_coinc += 1
+            j += 1
+    rate = len(cand) / duration
+    expected = 2.0 * rate * window * len(ref)
+    norm = 1.0 - 2.0 * rate * window
+    if norm <= 0.0:
+        return 1.0 if n_coinc == len(ref) == len(cand) else 0.0
+    return (n_coinc - expected) / (0.5 * (len(ref) + len(cand)) * norm)
+
+
+def compare(ref_dir, cand_dir, tau, window, ref_stride=1):
+    """ref_stride > 1: the candidate is written on a coarser grid, and every ref_stride-th row of the reference is compared."""
+    sq_cell, n_step, v_max, t_last = None, 0, 0.0, 0.0
+    ref_rows = itertools.islice(voltage_rows(ref_dir), 0, None, ref_stride)
+    for ref_row, cand_row in itertools.zip_longest(ref_rows, voltage_rows(cand_dir)):
+        if ref_row is None or cand_row is None:
+            print(f"Error: the runs differ in length (from {t_last} ms)")
+            sys.exit(1)
+        (t, r), (t_c, c) = ref_row, cand_row
+        if len(r) != len(c) or abs(t - t_c) > 1e-6:
+            print(f"Error: the runs differ in the number of cells or in time ({len(r)} cells at {t} ms vs {len(c)} cells at {t_c} ms)")
+            sys.exit(1)
+        if sq_cell is None:
+            sq_cell = [0.0] * len(r)
+        for i, (x, y) in enumerate(zip(r, c)):
+            e = x - y
+            sq_cell[i] += e * e
+            v_max = max(v_max, abs(e))
+        n_step += 1
+        t_last = t
+    if not n_step:
+        print("Error: no membrane potentials to compare")
+        sys.exit(1)
+    n_cells = len(sq_cell)
+    v_rms = math.sqrt(sum(sq_cell) / (n_step * n_cells))
+    v_rms_cell = math.sqrt(max(sq_cell) / n_step)
+
+    ref, cand = spike_trains(ref_dir), spike_trains(cand_dir)
+    duration = max(t_last, 1.0)
+    vr = [van_rossum(ref.get(i, []), cand.get(i, []), tau) for i in range(n_cells)]
+    gamma = [coincidence(ref.get(i, []), cand.get(i, []), window, duration) for i in range(n_cells)]
+    spikes_ref, spikes_cand = sum(len(t) for t in ref.values()), sum(len(t) for t in cand.values())
+    return {
+        'cells': n_cells, 'steps': n_step,
+        'spikes_ref': spikes_ref, 'spikes_cand': spikes_cand, 'rate_error': abs(spikes_cand - spikes_ref) / max(spikes_ref, 1),
+        'v_rms': v_rms, 'v_rms_cell': v_rms_cell, 'v_max': v_max,
+        'van_rossum_mean': sum(vr) / n_cells, 'van_rossum_max': max(vr),
+        'coincidence_mean': sum(gamma) / n_cells, 'coincidence_min': min(gamma),
+    }
+
+
+def check(r, max_v_rms, max_van_rossum, min_coincidence, max_rate_error):
+    """Print the report; return True if all tolerances hold."""
+    print(f"cells {r['cells']}, steps {r['steps']}, spikes {r['spikes_ref']} (ref) / {r['spikes_cand']} (cand)")
+    print(f"v_rms_cell {r['v_rms_cell']:.6g} mV, v_max {r['v_max']:.6g} mV, "
+          f"van_rossum_mean {r['van_rossum_mean']:.6g}, coincidence_min {r['coincidence_min']:.6g}")
+    ok = True
+    for name, value, limit, passed in [
+            ('v_rms', r['v_rms'], f"<= {max_v_rms}", r['v_rms'] <= max_v_rms),
+            ('van_rossum_max', r['van_rossum_max'], f"<= {max_van_rossum}", r['van_rossum_max'] <= max_van_rossum),
+            ('coincidence_mean', r['coincidence_mean'], f">= {min_coincidence}", r['coincidence_mean'] >= min_coincidence),
+            ('rate_error', r['rate_error'], f"<= {max_rate_error}", r['rate_error'] <= max_rate_error)]:
+        print(f"{'PASS' if passed else 'FAIL'}: {name} = {value:.6g} ({limit})")
+        ok = ok and passed
+    return ok
+
+
+def add_tolerance_arguments(parser):
+    parser.add_argument('--max-v-rms', type=float, default=1.0, help="[mV]")
+    parser.add_argument('--max-van-rossum', type=float, default=1.0, help="per cell")
+    parser.add_argument('--min-coincidence', type=float, default=0.9, help="mean over cells")
+    parser.add_argument('--max-rate-error', type=float, default=0.1, help="relative, # spikes of all cells")
+    parser.add_argument('--tau', type=float, default=10.0, help="van Rossum time constant [ms]")
+    parser.add_argument('--window', type=float, default=2.0, help="coincidence window [ms]")
+    parser.add_argument('--ref-stride', type=int, default=1, help="compare every N-th row of the reference (coarser DT of the candidate)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the outputs of two runs")
+    add_tolerance_arguments(parser)
+    parser.add_argument('ref_dir')
+    parser.add_argument('cand_dir')
+    args = parser.parse_args()
+
+    r = compare(args.ref_dir, args.cand_dir, args.tau, args.window, args.ref_stride)
+    sys.exit(0 if check(r, args.max_v_rms, args.max_van_rossum, args.min_coincidence, args.max_rate_error) else 1)
+
+
+if __name__ == "__main__":
+    main()
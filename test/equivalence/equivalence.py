@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+Numerical equivalence test
+
+Builds a reference and a candidate nl, runs both on a test network and
+compares the outputs with compare.py; the exit code is 1 when a tolerance
+is exceeded. The candidate is usually the same source with a fast path
+switched on in config.h (--set), a flavor (--src), or more threads or ranks.
+
+Usage:
+    python equivalence.py [--ref-src ../../kernel] [--ref-set KEY=VALUE ...]
+                          [--src ../../kernel] [--set KEY=VALUE ...] [--makefile M]
+                          [--threads N] [--ranks N] [--network kernel-test] [--tstop 1000]
+                          [--ref-population p.csv] [--population p.csv]
+                          [--ref-connection c.csv] [--connection c.csv]
+                          [tolerances of compare.py]
+
+Example:
+    python equivalence.py --set MULTISPLIT=4 --threads 2 --makefile Makefiles/Makefile.linuxomp
+"""
+import sys
+import os
+import shutil
+import argparse
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..', 'benchmark'))
+
+from bench import build, run
+from compare import compare, check, add_tolerance_arguments
+
+
+def settings(pairs):
+    config = {}
+    for pair in pairs:
+        key, sep, value = pair.partition('=')
+        if not sep:
+            print(f"Error: {pair} is not KEY=VALUE")
+            sys.exit(1)
+        config[key] = value
+    return config
+
+
+def prepare(netdir, network, population, connection):
+    """Run directory with the CSV files of the test network (population as p.csv, connection as c.csv); the outputs are written there."""
+    if os.path.exists(netdir):
+        shutil.rmtree(netdir)
+    os.makedirs(netdir)
+    shutil.copy(os.path.join(network, population), os.path.join(netdir, 'p.csv'))
+    shutil.copy(os.path.join(network, connection), os.path.join(netdir, 'c.csv'))
+    os.symlink(os.path.join(network, 'data'), os.path.join(netdir, 'data'))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Neulite numerical equivalence test")
+    parser.add_argument('--ref-src', default=os.path.join(HERE, '..', '..', 'kernel'))
+    parser.add_argument('--ref-set', nargs='*', default=[], metavar='KEY=VALUE')
+    parser.add_argument('--ref-makefile', default='Makefile')
+    parser.add_argument('--src', default=os.path.join(HERE, '..', '..', 'kernel'))
+    parser.add_argument('--set', nargs='*', default=[], metavar='KEY=VALUE')
+    parser.add_argument('--makefile', default='Makefile')
+    parser.add_argument('--threads', type=int, default=1)
+    parser.add_argument('--ranks', type=int, default=None)
+    parser.add_argument('--mpirun', default='mpirun')
+    parser.add_argument('--network', default='kernel-test', help="directory under test/ with p.csv and c.csv")
+    parser.add_argument('--ref-population', default='p.csv', help="population file of the reference in the network directory")
+    parser.add_argument('--population', default='p.csv', help="population file of the candidate")
+    parser.add_argument('--ref-connection', default='c.csv', help="connection file of the reference in the network directory")
+    parser.add_argument('--connection', default='c.csv', help="connection file of the candidate")
+    parser.add_argument('--tstop', type=float, default=1000.0)
+    parser.add_argument('--workdir', default=os.path.join(HERE, 'work'))
+    add_tolerance_arguments(parser)
+    args = parser.parse_args()
+
+    network = os.path.abspath(os.path.join(HERE, '..', args.network))
+    outputs = []
+    for label, src, pairs, makefile, threads, ranks, population, connection in [
+            ('ref', args.ref_src, args.ref_set, args.ref_makefile, 1, None, args.ref_population, args.ref_connection),
+            ('cand', args.src, args.set, args.makefile, args.threads, args.ranks, args.population, args.connection)]:
+        config = dict({'TSTOP': args.tstop}, **settings(pairs))
+        nl = build(os.path.abspath(src), os.path.join(args.workdir, f'build_{label}'), makefile, config)
+        netdir = os.path.join(args.workdir, label)
+        prepare(netdir, network, population, connection)
+        elapsed, n_spikes = run(nl, netdir, threads, ranks, args.mpirun)
+        print(f"{label}: {os.path.relpath(os.path.abspath(src), os.path.join(HERE, '..', '..'))} "
+              f"{' '.join(pairs)} threads {threads} ranks {ranks or 1}: {elapsed:.3f} s, {n_spikes} spikes")
+        outputs.append(netdir)
+
+    r = compare(outputs[0], outputs[1], args.tau, args.window, args.ref_stride)
+    sys.exit(0 if check(r, args.max_v_rms, args.max_van_rossum, args.min_coincidence, args.max_rate_error) else 1)
+
+
+if __name__ == "__main__":
+    main()